@@ -10,12 +10,19 @@ let package = Package(
         .library(
             name: "JxlCoder",
             targets: ["JxlCoder"]),
+        .executable(
+            name: "jxl-transcode",
+            targets: ["JxlTranscodeTool"]),
     ],
     targets: [
         .target(
             name: "JxlCoder",
             dependencies: ["jxlc"],
             path: "Sources/JxlCoder"),
+        .executableTarget(
+            name: "JxlTranscodeTool",
+            dependencies: ["JxlCoder"],
+            path: "Sources/JxlTranscodeTool"),
         .target(name: "jxlc",
                 dependencies: ["libbrotlicommon", "libbrotlidec", "libbrotlienc", "libhwy",
                                "libjxl_threads", "libjxl", "libjxl_cms", "libskcms",
@@ -26,7 +33,9 @@ let package = Package(
                     .define("HWY_COMPILE_ONLY_STATIC", to: "1")],
                 cxxSettings: [.headerSearchPath("./algo")],
                 linkerSettings: [
-                    .linkedFramework("Accelerate")
+                    .linkedFramework("Accelerate"),
+                    .linkedFramework("CoreVideo"),
+                    .linkedLibrary("z")
                 ]),
         .binaryTarget(name: "libbrotlicommon", path: "Sources/Frameworks/libbrotlicommon.xcframework"),
         .binaryTarget(name: "libbrotlidec", path: "Sources/Frameworks/libbrotlidec.xcframework"),
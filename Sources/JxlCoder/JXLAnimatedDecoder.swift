@@ -32,18 +32,80 @@ public class JXLAnimatedDecoder {
 
     private let dec: CJpegXLAnimatedDecoder
 
-    public init(data: Data) throws {
+    /***
+     - Parameter targetSize: frames are decoded already scaled to fit into the size with the aspect ratio kept, never upscaled, only for r8 pixel format
+     - Parameter pixelFormat: sample type of decoded frames, optimal picks float16 for images deeper than 8 bits
+     - Parameter rgbOnly: frames are decoded without the alpha channel
+     **/
+    public init(data: Data, targetSize: CGSize? = nil,
+                pixelFormat: JXLPreferredPixelFormat = .r8, rgbOnly: Bool = false) throws {
         dec = try CJpegXLAnimatedDecoder(data)
+        if pixelFormat != .r8 || rgbOnly {
+            try dec.setPixelFormat(pixelFormat, rgbOnly: rgbOnly)
+        }
+        if let targetSize {
+            try dec.setTargetSize(targetSize)
+        }
     }
 
+    /// 0 when a frame header is corrupt
     public var numberOfFrames: Int {
         Int(dec.framesCount())
     }
 
+    /// Duration in milliseconds, -1 when a frame header is corrupt
     public func frameDuration(_ frame: Int) -> Int {
         return Int(dec.frameDuration(Int32(frame)))
     }
 
+    /// Total duration of all frames in milliseconds, scans headers of all frames, -1 when a frame header is corrupt
+    public var totalDuration: Int {
+        Int(dec.totalDuration())
+    }
+
+    /// Frame headers are scanned as frames are reached, this finishes the scan on a background thread
+    /// so `numberOfFrames` and `totalDuration` don't block later
+    public func completeScanInBackground() {
+        dec.completeScanInBackground()
+    }
+
+    public var isScanComplete: Bool {
+        dec.isScanComplete()
+    }
+
+    /**
+     Frame durations in ticks last `denominator / numerator` seconds, 1000 / 1 for millisecond timing
+     */
+    public var timebase: (numerator: UInt32, denominator: UInt32) {
+        var numerator: UInt32 = 0
+        var denominator: UInt32 = 0
+        dec.timebaseNumerator(&numerator, denominator: &denominator)
+        return (numerator, denominator)
+    }
+
+    /**
+     Exact duration of the frame in ticks of `timebase`
+     */
+    public func frameTicks(_ frame: Int) -> Int {
+        Int(dec.frameTicks(Int32(frame)))
+    }
+
+    /**
+     SMPTE timecode of the frame, nil when the animation doesn't store timecodes
+     */
+    public func frameTimecode(_ frame: Int) -> UInt32? {
+        dec.hasTimecodes() ? dec.frameTimecode(Int32(frame)) : nil
+    }
+
+    /**
+     Frame shown at the time from the animation start, found by binary search over cumulative frame durations
+     - Returns: nil when the time is past the end of a single loop
+     */
+    public func frameIndex(at time: TimeInterval) -> Int? {
+        let index = dec.frameIndex(atTime: time)
+        return index >= 0 ? Int(index) : nil
+    }
+
     public var loopsCount: Int {
         Int(dec.loopCount())
     }
@@ -52,4 +114,74 @@ public class JXLAnimatedDecoder {
         try dec.get(Int32(frame))
     }
 
+    /***
+     - Parameter frames: range of frames to decode, segments between independent frames are decoded concurrently
+     - Parameter threads: 0 means one per core
+     **/
+    public func exportFrames(_ frames: Range<Int>, threads: Int = 0) throws -> [JXLPlatformImage] {
+        try dec.exportFrames(NSRange(location: frames.lowerBound, length: frames.count), numThreads: Int32(threads))
+    }
+
+    /***
+     - Parameter lookahead: frames decoded ahead on a background thread
+     - Parameter memoryLimit: bytes prefetched frames may occupy, 0 means no limit, at least one frame is always kept
+     **/
+    public func startPlayback(lookahead: Int = 3, memoryLimit: Int = 0) {
+        dec.startPlayback(Int32(lookahead), memoryLimit: UInt(max(memoryLimit, 0)))
+    }
+
+    public func stopPlayback() {
+        dec.stopPlayback()
+    }
+
+    /***
+     - Returns: next frame in display order, wrapping at the end of the animation, nil once all loops were played
+     **/
+    public func nextPlaybackFrame() throws -> JXLPlaybackFrame? {
+        var frame: Int32 = 0
+        var duration: Int32 = 0
+        var error: NSError?
+        let image = dec.nextPlaybackFrame(&frame, duration: &duration, error: &error)
+        if let error {
+            throw error
+        }
+        guard let image else {
+            return nil
+        }
+        return JXLPlaybackFrame(image: image, frame: Int(frame), duration: Int(duration))
+    }
+
+    /***
+     - Returns: changed region of the next frame, composited from raw layers, so only that region has to be redrawn; nil after the last frame, the next call starts over
+     **/
+    public func nextFrameUpdate() throws -> JXLFrameUpdate? {
+        var rect = CGRect.zero
+        var duration: Int32 = 0
+        var error: NSError?
+        let image = dec.nextFrameUpdate(&rect, duration: &duration, error: &error)
+        if let error {
+            throw error
+        }
+        guard let image else {
+            return nil
+        }
+        return JXLFrameUpdate(image: image, rect: rect, duration: Int(duration))
+    }
+
+    public var playbackStatistics: JXLPlaybackStatistics {
+        var decodedFrames: Int32 = 0
+        var slowFrames: Int32 = 0
+        var underruns: Int32 = 0
+        var meanDecodeTime: Double = 0
+        var maxDecodeTime: Double = 0
+        var meanFrameDuration: Double = 0
+        dec.playbackStatistics(&decodedFrames, slowFrames: &slowFrames, underruns: &underruns,
+                               meanDecodeTime: &meanDecodeTime, maxDecodeTime: &maxDecodeTime,
+                               meanFrameDuration: &meanFrameDuration)
+        return JXLPlaybackStatistics(decodedFrames: Int(decodedFrames), slowFrames: Int(slowFrames),
+                                     underruns: Int(underruns), meanDecodeTime: meanDecodeTime / 1000,
+                                     maxDecodeTime: maxDecodeTime / 1000,
+                                     meanFrameDuration: meanFrameDuration / 1000)
+    }
+
 }
@@ -24,6 +24,7 @@
 //
 
 import Foundation
+import CoreVideo
 #if canImport(jxlc)
 import jxlc
 #endif
@@ -32,11 +33,23 @@ public class JXLAnimatedEncoder {
     
     private let enc: CJpegXLAnimatedEncoder
     
+    /**
+     - Parameter timebase: ticks per second as numerator / denominator, frame durations are given in ticks.
+     The default 1000 / 1 keeps durations in milliseconds, 30000 / 1001 gives NTSC frame exact timing
+     - Parameter timecodes: stores the `timecode` of every frame's options in the frame header
+     - Parameter transferFunction: `.automatic` tags integer formats as sRGB and floats as linear,
+     `.pq` and `.hlg` accept frames added as pixels only
+     */
     public init(width: Int, height: Int,
                 numLoops: Int = 0, // 0 - means infinity
                 colorSpace: JXLColorSpace = .rgba,
                 compressionOption: JXLCompressionOption = .lossy,
-                effort: Int = 4, quality: Int = 0, decodingSpeed: JXLEncoderDecodingSpeed = .slowest) throws {
+                effort: Int = 4, quality: Int = 0, decodingSpeed: JXLEncoderDecodingSpeed = .slowest,
+                pixelFormat: JXLPreferredPixelFormat = .r8,
+                timebase: (numerator: UInt32, denominator: UInt32) = (1000, 1),
+                timecodes: Bool = false,
+                transferFunction: JXLTransferFunction = .automatic,
+                options: JXLEncoderOptions? = nil) throws {
         enc = try CJpegXLAnimatedEncoder(Int32(width),
                                          height: Int32(height),
                                          numLoops: Int32(numLoops),
@@ -44,15 +57,92 @@ public class JXLAnimatedEncoder {
                                          compressionOption: compressionOption,
                                          effort: Int32(effort),
                                          quality: Int32(quality),
-                                         decodingSpeed: decodingSpeed)
+                                         decodingSpeed: decodingSpeed,
+                                         pixelFormat: pixelFormat,
+                                         timebaseNumerator: timebase.numerator,
+                                         timebaseDenominator: timebase.denominator,
+                                         timecodes: timecodes,
+                                         transferFunction: transferFunction,
+                                         options: options)
     }
     
     /**
      - Parameter frame: all the frames must match provided width and height in constructor
-     - Parameter duration: length of the frame in milliseconds
+     - Parameter duration: length of the frame in ticks of the timebase, milliseconds by default
+     - Parameter options: overrides distance, effort, lossless mode or reference use of this frame only, e.g. cheaper settings for transitional frames
+     */
+    public func add(frame: JXLPlatformImage, duration ticks: Int, options: JXLAnimationFrameOptions? = nil) throws {
+        try enc.addFrame(frame, duration: Int32(ticks), options: options)
+    }
+    
+    /**
+     - Parameter pixels: interleaved RGB or RGBA samples matching `colorSpace` and `pixelFormat` of the encoder,
+     UInt16 for r16, Float16 for float16 and Float for float32, encoded with the transfer function of the encoder,
+     linear by default for floats
+     - Parameter duration: length of the frame in ticks of the timebase, milliseconds by default
+     */
+    public func add(pixels: Data, duration ticks: Int, options: JXLAnimationFrameOptions? = nil) throws {
+        try enc.addFramePixels(pixels, duration: Int32(ticks), options: options)
+    }
+    
+    /**
+     Adds a video frame without converting it to RGB beforehand, the conversion runs multithreaded inside the encoder
+     - Parameter pixelBuffer: NV12, I420 or P010 buffer (420v, 420f, y420, f420, x420 or xf20), range follows the format type
+     - Parameter matrix: YCbCr matrix the buffer was produced with
+     - Parameter duration: length of the frame in ticks of the timebase, milliseconds by default
+     */
+    public func add(pixelBuffer: CVPixelBuffer, matrix: JXLYUVMatrix = .bt709,
+                    duration ticks: Int, options: JXLAnimationFrameOptions? = nil) throws {
+        try enc.addFramePixelBuffer(pixelBuffer, matrix: matrix, duration: Int32(ticks), options: options)
+    }
+    
+    /**
+     - Parameter enabled: when true, which is the default, frames after the first one store only the region that differs from the previous frame
+     */
+    public func setCropChangedRegions(_ enabled: Bool) {
+        enc.setCropChangedRegions(enabled)
+    }
+    
+    /**
+     - Parameter enabled: when true, which is the default, a frame identical to the previous one extends its duration instead of being encoded
+     */
+    public func setCoalesceDuplicates(_ enabled: Bool) {
+        enc.setCoalesceDuplicates(enabled)
+    }
+    
+    /**
+     Encodes frames on a dedicated thread, `add(frame:duration:)` only converts pixels and queues them
+     - Parameter queueSize: how many frames may wait for encoding before `add(frame:duration:)` blocks
+     */
+    public func startAsync(queueSize: Int = 4) {
+        enc.startAsync(Int32(queueSize))
+    }
+    
+    /**
+     Streams encoded bytes while frames are added, `finish()` then returns empty data.
+     Must be called before the first frame
+     - Parameter handler: receives each finished chunk, returning false stops encoding with an error
+     */
+    public func setOutput(handler: @escaping (Data) -> Bool) throws {
+        try enc.setOutputHandler { chunk in
+            handler(chunk)
+        }
+    }
+    
+    /**
+     Converts a GIF or APNG animation into JXL without decoding every frame upfront,
+     disposal and blending of the source are kept, unchanged regions are stored as cropped frames
+     - Parameter data: GIF, APNG or PNG file contents
      */
-    public func add(frame: JXLPlatformImage, duration ms: Int) throws {
-        try enc.addFrame(frame, duration: Int32(ms))
+    public static func importAnimation(data: Data,
+                                       compressionOption: JXLCompressionOption = .lossy,
+                                       effort: Int = 4, quality: Int = 0,
+                                       decodingSpeed: JXLEncoderDecodingSpeed = .slowest) throws -> Data {
+        try CJpegXLAnimatedEncoder.importAnimation(data,
+                                                   compressionOption: compressionOption,
+                                                   effort: Int32(effort),
+                                                   quality: Int32(quality),
+                                                   decodingSpeed: decodingSpeed)
     }
     
     public func finish() throws -> Data {
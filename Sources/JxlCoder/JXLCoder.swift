@@ -91,8 +91,25 @@ public class JXLCoder {
     }
 
     /***
+     Decodes a small image from the head of the file without touching the rest of the codestream.
+     The embedded preview is used when present, otherwise the DC of the first frame, files encoded
+     with `JXLEncoderOptions(preset: .progressiveWeb)` keep it at the very beginning.
+     - Parameter data: the file or only its head
+     - Parameter maxSize: bounding box of the preview, the aspect ratio is kept, `.zero` keeps the decoded size
+     - Parameter scale: scale of UIImage
+     - Returns: Preview image
+     **/
+    public static func decodePreview(data: Data,
+                                     maxSize: CGSize = .zero,
+                                     scale: Int = 1) throws -> JXLPlatformImage {
+        return try shared.decodePreview(data, maxSize: maxSize, scale: Int32(scale))
+    }
+
+    /***
+     - Parameter colorSpace: `.automatic` drops opaque alpha and collapses grayscale content to a single channel
      - Parameter quality: 0...100
      - Parameter effort: 1...9
+     - Parameter options: advanced settings or a preset, e.g. `JXLEncoderOptions(preset: .progressiveWeb)`
      - Returns: JXL data of the image
      **/
     public static func encode(image: JXLPlatformImage,
@@ -100,20 +117,196 @@ public class JXLCoder {
                               compressionOption: JXLCompressionOption = .lossy,
                               effort: Int = 7,
                               quality: Int = 0,
-                              decodingSpeed: JXLEncoderDecodingSpeed = .slowest) throws -> Data {
+                              decodingSpeed: JXLEncoderDecodingSpeed = .slowest,
+                              options: JXLEncoderOptions? = nil) throws -> Data {
         return try shared.encode(image, colorSpace: colorSpace,
                                  compressionOption: compressionOption,
                                  effort: Int32(effort),
                                  quality: Int32(quality),
-                                 decodingSpeed: decodingSpeed)
+                                 decodingSpeed: decodingSpeed,
+                                 options: options)
     }
     
+    /***
+     Encodes one image at several sizes, the downscale pyramid is built once and shared by every rendition,
+     all renditions are encoded concurrently
+     - Parameter targets: width, quality and effort of every rendition
+     - Returns: Encoded renditions in the order of targets
+     **/
+    public static func encodeRenditions(image: JXLPlatformImage,
+                                        targets: [JXLRenditionTarget],
+                                        colorSpace: JXLColorSpace = .rgb,
+                                        decodingSpeed: JXLEncoderDecodingSpeed = .slowest,
+                                        options: JXLEncoderOptions? = nil) throws -> [JXLRendition] {
+        let widths = NSMutableArray()
+        let heights = NSMutableArray()
+        let durations = NSMutableArray()
+        let data = try shared.encodeRenditions(image, colorSpace: colorSpace,
+                                               widths: targets.map { NSNumber(value: $0.width) },
+                                               qualities: targets.map { NSNumber(value: $0.quality) },
+                                               efforts: targets.map { NSNumber(value: $0.effort) },
+                                               decodingSpeed: decodingSpeed,
+                                               options: options,
+                                               renditionWidths: widths,
+                                               renditionHeights: heights,
+                                               durations: durations)
+        return data.enumerated().map { index, rendition in
+            JXLRendition(data: rendition,
+                         width: (widths[index] as? NSNumber)?.intValue ?? 0,
+                         height: (heights[index] as? NSNumber)?.intValue ?? 0,
+                         duration: (durations[index] as? NSNumber)?.doubleValue ?? 0)
+        }
+    }
+
+    /***
+     Lossless encoding tuned for throughput on screenshots and UI captures
+     - Parameter effort: 1...2, 1 takes the dedicated fast lossless encoder of libjxl
+     - Parameter fastDecode: trades a little density for cheaper decoding
+     - Returns: JXL data of the image
+     **/
+    public static func encodeFastLossless(image: JXLPlatformImage,
+                                          effort: Int = 1,
+                                          fastDecode: Bool = false) throws -> Data {
+        return try shared.encodeFastLossless(image, effort: Int32(effort), fastDecode: fastDecode)
+    }
+
+    /***
+     Encodes many images at once without oversubscribing the CPU: small images run on one thread each
+     with many in flight, large images are given several encoder threads
+     - Parameter coreBudget: threads the batch may occupy, 0 means one per core
+     - Returns: JXL data of every image, per-image latency and aggregate throughput
+     **/
+    public static func encode(images: [JXLPlatformImage],
+                              colorSpace: JXLColorSpace = .rgb,
+                              compressionOption: JXLCompressionOption = .lossy,
+                              effort: Int = 7,
+                              quality: Int = 0,
+                              decodingSpeed: JXLEncoderDecodingSpeed = .slowest,
+                              options: JXLEncoderOptions? = nil,
+                              coreBudget: Int = 0) throws -> JXLBatchEncodeResult {
+        let latencies = NSMutableArray()
+        var imagesPerSecond: Double = 0
+        var megapixelsPerSecond: Double = 0
+        let data = try shared.encodeBatch(images, colorSpace: colorSpace,
+                                          compressionOption: compressionOption,
+                                          effort: Int32(effort),
+                                          quality: Int32(quality),
+                                          decodingSpeed: decodingSpeed,
+                                          options: options,
+                                          coreBudget: Int32(coreBudget),
+                                          latencies: latencies,
+                                          imagesPerSecond: &imagesPerSecond,
+                                          megapixelsPerSecond: &megapixelsPerSecond)
+        return JXLBatchEncodeResult(data: data,
+                                    latencies: latencies.compactMap { ($0 as? NSNumber)?.doubleValue },
+                                    imagesPerSecond: imagesPerSecond,
+                                    megapixelsPerSecond: megapixelsPerSecond)
+    }
+
+    /***
+     Searches the lossy distance that keeps the encoded image within the byte budget
+     - Parameter targetSize: desired maximum size of the output in bytes
+     - Parameter effort: 1...9, trial encodes run at a lower effort, the final one at this effort
+     - Parameter maxIterations: upper bound of the search rounds
+     - Returns: JXL data of the image and the distance it was encoded with
+     **/
+    public static func encode(image: JXLPlatformImage,
+                              colorSpace: JXLColorSpace = .rgb,
+                              targetSize: Int,
+                              effort: Int = 7,
+                              decodingSpeed: JXLEncoderDecodingSpeed = .slowest,
+                              maxIterations: Int = 8,
+                              options: JXLEncoderOptions? = nil) throws -> JXLRateControlResult {
+        return try encode(image: image, colorSpace: colorSpace, rateTarget: .size,
+                          targetValue: Double(targetSize), effort: effort,
+                          decodingSpeed: decodingSpeed, maxIterations: maxIterations,
+                          options: options)
+    }
+
+    /***
+     Searches the largest lossy distance that still reaches the PSNR score
+     - Parameter targetPSNR: desired minimum PSNR of the output in dB
+     - Parameter effort: 1...9, trial encodes run at a lower effort, the final one at this effort
+     - Parameter maxIterations: upper bound of the search rounds
+     - Returns: JXL data of the image, the distance it was encoded with and the achieved PSNR
+     **/
+    public static func encode(image: JXLPlatformImage,
+                              colorSpace: JXLColorSpace = .rgb,
+                              targetPSNR: Double,
+                              effort: Int = 7,
+                              decodingSpeed: JXLEncoderDecodingSpeed = .slowest,
+                              maxIterations: Int = 8,
+                              options: JXLEncoderOptions? = nil) throws -> JXLRateControlResult {
+        return try encode(image: image, colorSpace: colorSpace, rateTarget: .psnr,
+                          targetValue: targetPSNR, effort: effort,
+                          decodingSpeed: decodingSpeed, maxIterations: maxIterations,
+                          options: options)
+    }
+
+    private static func encode(image: JXLPlatformImage,
+                               colorSpace: JXLColorSpace,
+                               rateTarget: JXLRateControlTarget,
+                               targetValue: Double,
+                               effort: Int,
+                               decodingSpeed: JXLEncoderDecodingSpeed,
+                               maxIterations: Int,
+                               options: JXLEncoderOptions?) throws -> JXLRateControlResult {
+        var distance: Float = 0
+        var psnr: Double = -1
+        let data = try shared.encode(image, colorSpace: colorSpace,
+                                     effort: Int32(effort),
+                                     decodingSpeed: decodingSpeed,
+                                     rateTarget: rateTarget,
+                                     targetValue: targetValue,
+                                     maxIterations: Int32(maxIterations),
+                                     achievedDistance: &distance,
+                                     achievedScore: &psnr,
+                                     options: options)
+        return JXLRateControlResult(data: data, distance: distance, psnr: psnr)
+    }
+
     /***
      - Parameter jpegData: Data that contains JPEG image to transcode into a JXL
+     - Parameter effort: 1...9, higher values give smaller files at the cost of time
+     - Parameter options: advanced settings, e.g. `brotliEffort` for the reconstruction data
      - Returns: JXL data of the image
      **/
-    public static func transcode(jpegData: Data) throws -> Data {
-        return try JxlConstruction.transcode(jpegData)
+    public static func transcode(jpegData: Data, effort: Int = 7, options: JXLEncoderOptions? = nil) throws -> Data {
+        return try JxlConstruction.transcode(jpegData, effort: Int32(effort), options: options)
+    }
+
+    /***
+     Losslessly transcodes JPEG files into JXL files on a pool of workers, each reusing one encoder for all of its files.
+     Inputs are memory mapped and outputs written to disk while they are encoded, a failed file doesn't stop the batch
+     - Parameter jpegFiles: JPEG files to transcode
+     - Parameter outputs: destination of every input, written only once complete. An input whose destination repeats an earlier one fails
+     - Parameter effort: 1...9
+     - Parameter workers: files transcoded concurrently, 0 means one per core
+     - Parameter progress: called from the workers once per finished file, calls never overlap
+     - Returns: per-file sizes, time and failures with aggregate throughput
+     **/
+    public static func transcode(jpegFiles: [URL],
+                                 to outputs: [URL],
+                                 effort: Int = 7,
+                                 workers: Int = 0,
+                                 options: JXLEncoderOptions? = nil,
+                                 progress: ((Int, JXLTranscodeFileReport) -> Void)? = nil) throws -> JXLTranscodeBatchResult {
+        var wallTime: Double = 0
+        var filesPerSecond: Double = 0
+        var megabytesPerSecond: Double = 0
+        let reports = try JxlConstruction.transcodeFiles(jpegFiles.map { $0.path },
+                                                         outputs: outputs.map { $0.path },
+                                                         effort: Int32(effort),
+                                                         workers: Int32(workers),
+                                                         options: options,
+                                                         progress: progress,
+                                                         wallTime: &wallTime,
+                                                         filesPerSecond: &filesPerSecond,
+                                                         megabytesPerSecond: &megabytesPerSecond)
+        return JXLTranscodeBatchResult(files: reports,
+                                       wallTime: wallTime,
+                                       filesPerSecond: filesPerSecond,
+                                       megabytesPerSecond: megabytesPerSecond)
     }
 
     /***
@@ -24,6 +24,9 @@
 //
 
 import Foundation
+#if canImport(jxlc)
+import jxlc
+#endif
 #if !os(macOS)
 import UIKit.UIImage
 import UIKit.UIColor
@@ -34,3 +37,94 @@ import AppKit.NSImage
 /// Alias for `NSImage`.
 public typealias JXLPlatformImage = NSImage
 #endif
+
+public struct JXLRateControlResult {
+    /// Encoded JXL data
+    public let data: Data
+    /// Butteraugli distance of the final encode
+    public let distance: Float
+    /// PSNR of the final encode in dB, measured only for a PSNR target, otherwise -1
+    public let psnr: Double
+}
+
+public struct JXLBatchEncodeResult {
+    /// Encoded JXL data in the order of the input images
+    public let data: [Data]
+    /// Time from the batch submission until each image was encoded
+    public let latencies: [TimeInterval]
+    public let imagesPerSecond: Double
+    public let megapixelsPerSecond: Double
+}
+
+public struct JXLTranscodeBatchResult {
+    /// Reports in the order of the input files
+    public let files: [JXLTranscodeFileReport]
+    /// Duration of the whole batch
+    public let wallTime: TimeInterval
+    public let filesPerSecond: Double
+    /// JPEG megabytes consumed per second
+    public let megabytesPerSecond: Double
+
+    public var failedFiles: Int {
+        files.filter { !$0.succeed }.count
+    }
+
+    /// Fraction of the JPEG bytes saved over the successfully transcoded files
+    public var savings: Double {
+        let succeeded = files.filter { $0.succeed }
+        let input = succeeded.reduce(UInt64(0)) { $0 + $1.inputSize }
+        let output = succeeded.reduce(UInt64(0)) { $0 + $1.outputSize }
+        return input > 0 ? 1 - Double(output) / Double(input) : 0
+    }
+}
+
+public struct JXLRenditionTarget {
+    /// Width of the rendition, the height follows the aspect ratio, never larger than the source
+    public let width: Int
+    /// 0...100
+    public let quality: Int
+    /// 1...9
+    public let effort: Int
+
+    public init(width: Int, quality: Int = 0, effort: Int = 7) {
+        self.width = width
+        self.quality = quality
+        self.effort = effort
+    }
+}
+
+public struct JXLRendition {
+    public let data: Data
+    public let width: Int
+    public let height: Int
+    /// Time spent on resampling and encoding of this rendition
+    public let duration: TimeInterval
+}
+
+public struct JXLPlaybackFrame {
+    public let image: JXLPlatformImage
+    public let frame: Int
+    /// Display duration in milliseconds
+    public let duration: Int
+}
+
+public struct JXLPlaybackStatistics {
+    public let decodedFrames: Int
+    /// Frames that took longer to decode than they are displayed
+    public let slowFrames: Int
+    /// Times playback had to wait for a frame that wasn't decoded yet
+    public let underruns: Int
+    /// Mean and max time spent on decoding a frame
+    public let meanDecodeTime: TimeInterval
+    public let maxDecodeTime: TimeInterval
+    public let meanFrameDuration: TimeInterval
+}
+
+public struct JXLFrameUpdate {
+    /// Image of the changed region only
+    public let image: JXLPlatformImage
+    /// Where the image goes on the animation canvas, top left origin, in pixels
+    public let rect: CGRect
+    /// Display duration in milliseconds
+    public let duration: Int
+}
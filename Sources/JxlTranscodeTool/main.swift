@@ -0,0 +1,179 @@
+//
+//  main.swift
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+import Foundation
+import JxlCoder
+#if canImport(jxlc)
+import jxlc
+#endif
+
+/**
+ Losslessly transcodes every JPEG of a directory into JXL, mirroring the directory layout in the output
+
+ Usage: jxl-transcode [--effort 1...9] [--workers N] [--recursive] [--quiet] <input-dir> <output-dir>
+ */
+
+func printUsage() {
+    let usage = "Usage: jxl-transcode [--effort 1...9] [--workers N] [--recursive] [--quiet] <input-dir> <output-dir>\n"
+    FileHandle.standardError.write(usage.data(using: .utf8)!)
+}
+
+func fail(_ message: String) -> Never {
+    FileHandle.standardError.write("\(message)\n".data(using: .utf8)!)
+    exit(2)
+}
+
+var effort = 7
+var workers = 0
+var recursive = false
+var quiet = false
+var positional: [String] = []
+
+var arguments = CommandLine.arguments.dropFirst().makeIterator()
+while let argument = arguments.next() {
+    switch argument {
+    case "--effort":
+        guard let value = arguments.next().flatMap({ Int($0) }), (1...9).contains(value) else {
+            fail("--effort expects a value in 1...9")
+        }
+        effort = value
+    case "--workers":
+        guard let value = arguments.next().flatMap({ Int($0) }), value >= 0 else {
+            fail("--workers expects a non-negative number")
+        }
+        workers = value
+    case "--recursive", "-r":
+        recursive = true
+    case "--quiet", "-q":
+        quiet = true
+    case "--help", "-h":
+        printUsage()
+        exit(0)
+    default:
+        positional.append(argument)
+    }
+}
+
+guard positional.count == 2 else {
+    printUsage()
+    exit(2)
+}
+
+// Only the root is resolved, so a linked input directory is still enumerated
+let inputDirectory = URL(fileURLWithPath: positional[0], isDirectory: true).resolvingSymlinksInPath()
+let outputDirectory = URL(fileURLWithPath: positional[1], isDirectory: true).standardizedFileURL
+let fileManager = FileManager.default
+let jpegExtensions: Set<String> = ["jpg", "jpeg", "jpe", "jfif"]
+
+// Paths relative to the input directory as enumerated, links are kept at their own location
+guard let enumerator = fileManager.enumerator(atPath: inputDirectory.path) else {
+    fail("Cannot read directory \(inputDirectory.path)")
+}
+var relativePaths: [String] = []
+while let relativePath = enumerator.nextObject() as? String {
+    let name = (relativePath as NSString).lastPathComponent
+    let isDirectory = enumerator.fileAttributes?[.type] as? FileAttributeType == .typeDirectory
+    if isDirectory {
+        if !recursive || name.hasPrefix(".") {
+            enumerator.skipDescendants()
+        }
+        continue
+    }
+    var isTargetDirectory: ObjCBool = false
+    guard !name.hasPrefix("."),
+          jpegExtensions.contains((name as NSString).pathExtension.lowercased()),
+          fileManager.fileExists(atPath: inputDirectory.appendingPathComponent(relativePath).path,
+                                 isDirectory: &isTargetDirectory),
+          !isTargetDirectory.boolValue else {
+        continue
+    }
+    relativePaths.append(relativePath)
+}
+relativePaths.sort()
+
+// a.jpg and a.jpeg would both become a.jxl, later ones keep their extension in the name.
+// Compared case-insensitively since the default Apple file systems are
+var takenOutputs = Set<String>()
+var inputs: [URL] = []
+var outputs: [URL] = []
+for relativePath in relativePaths {
+    let stem = (relativePath as NSString).deletingPathExtension
+    var candidate = stem + ".jxl"
+    if !takenOutputs.insert(candidate.lowercased()).inserted {
+        candidate = relativePath + ".jxl"
+        var attempt = 2
+        while !takenOutputs.insert(candidate.lowercased()).inserted {
+            candidate = "\(relativePath).\(attempt).jxl"
+            attempt += 1
+        }
+    }
+    let destination = outputDirectory.appendingPathComponent(candidate)
+    do {
+        try fileManager.createDirectory(at: destination.deletingLastPathComponent(), withIntermediateDirectories: true)
+    } catch {
+        fail("Cannot create directory \(destination.deletingLastPathComponent().path): \(error.localizedDescription)")
+    }
+    inputs.append(inputDirectory.appendingPathComponent(relativePath))
+    outputs.append(destination)
+}
+
+if inputs.isEmpty {
+    print("No JPEG files found in \(inputDirectory.path)")
+    exit(0)
+}
+
+let byteFormatter = ByteCountFormatter()
+byteFormatter.countStyle = .file
+
+do {
+    let result = try JXLCoder.transcode(jpegFiles: inputs, to: outputs, effort: effort, workers: workers) { index, report in
+        if report.succeed {
+            if !quiet {
+                let savings = report.inputSize > 0 ? 100 * (1 - Double(report.outputSize) / Double(report.inputSize)) : 0
+                print(String(format: "%@: %@ -> %@ (%.1f%% saved) in %.0f ms",
+                             inputs[index].path,
+                             byteFormatter.string(fromByteCount: Int64(report.inputSize)),
+                             byteFormatter.string(fromByteCount: Int64(report.outputSize)),
+                             savings, report.time * 1000))
+            }
+        } else {
+            let message = "\(inputs[index].path): FAILED \(report.errorMessage ?? "unknown error")\n"
+            FileHandle.standardError.write(message.data(using: .utf8)!)
+        }
+    }
+
+    let succeeded = result.files.filter { $0.succeed }
+    let inputBytes = succeeded.reduce(Int64(0)) { $0 + Int64($1.inputSize) }
+    let outputBytes = succeeded.reduce(Int64(0)) { $0 + Int64($1.outputSize) }
+    print(String(format: "%ld files, %ld failed, %@ -> %@ (%.1f%% saved), %.2f s, %.1f files/s, %.1f MB/s",
+                 result.files.count, result.failedFiles,
+                 byteFormatter.string(fromByteCount: inputBytes),
+                 byteFormatter.string(fromByteCount: outputBytes),
+                 result.savings * 100, result.wallTime,
+                 result.filesPerSecond, result.megabytesPerSecond))
+    exit(result.failedFiles == 0 ? 0 : 1)
+} catch {
+    fail(error.localizedDescription)
+}
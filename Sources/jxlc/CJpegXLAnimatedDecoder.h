@@ -31,11 +31,82 @@
 
 @interface CJpegXLAnimatedDecoder : NSObject
 -(nullable id)initWith:(nonnull NSData*)data error:(NSError * _Nullable *_Nullable)error;
+/**
+ * Frames are decoded already scaled to fit into the size, keeping the aspect ratio and never upscaling.
+ * CGSizeZero restores the full canvas size. Stops the playback
+ */
+-(BOOL)setTargetSize:(CGSize)size error:(NSError *_Nullable * _Nullable)error;
+/**
+ * Sample type of decoded frames, r8 by default. Optimal picks float16 for images deeper than 8 bits.
+ * Scaled frames are available only for r8. Stops the playback
+ * @param rgbOnly frames are decoded without the alpha channel
+ */
+-(BOOL)setPixelFormat:(JXLPreferredPixelFormat)pixelFormat
+              rgbOnly:(BOOL)rgbOnly
+                error:(NSError *_Nullable * _Nullable)error;
+/**
+ * Frame headers are scanned lazily as frames are reached, frames count and total duration scan all of them.
+ * A corrupt frame header gives 0 frames and -1 durations
+ */
 -(NSUInteger)framesCount;
+-(int)totalDuration;
+/**
+ * Finishes the frame header scan on a background thread
+ */
+-(void)completeScanInBackground;
+-(BOOL)isScanComplete;
 -(int)frameDuration:(int)frame;
+/**
+ * Durations in ticks last denominator / numerator seconds
+ */
+-(void)timebaseNumerator:(nonnull uint32_t*)numerator denominator:(nonnull uint32_t*)denominator;
+/**
+ * 0 for frames past the end or behind a corrupt frame header
+ */
+-(uint32_t)frameTicks:(int)frame;
+-(BOOL)hasTimecodes;
+-(uint32_t)frameTimecode:(int)frame;
+/**
+ * Frame displayed at the time from the animation start, -1 when the time is past the end
+ */
+-(int)frameIndexAtTime:(double)seconds;
 -(int)loopCount;
 -(nullable JXLSystemImage *)get:(int)frame
                             error:(NSError *_Nullable * _Nullable)error;
+/**
+ * Decodes a range of frames at once, segments between keyframes are decoded concurrently
+ * @param numThreads 0 means one per core
+ */
+-(nullable NSArray<JXLSystemImage *> *)exportFrames:(NSRange)range
+                                          numThreads:(int)numThreads
+                                               error:(NSError *_Nullable * _Nullable)error;
+/**
+ * Starts decoding frames ahead on a background thread, in display order with loop wrapping
+ * @param lookahead frames decoded ahead
+ * @param memoryLimit bytes the prefetched frames may occupy, 0 means no limit
+ */
+-(void)startPlayback:(int)lookahead memoryLimit:(NSUInteger)memoryLimit;
+-(void)stopPlayback;
+/**
+ * @return next prefetched frame, nil without an error once all loops were played
+ */
+-(nullable JXLSystemImage *)nextPlaybackFrame:(nullable int*)frame
+                                     duration:(nullable int*)duration
+                                        error:(NSError *_Nullable * _Nullable)error NS_SWIFT_NOTHROW;
+/**
+ * Decodes the next frame from its non-coalesced layers and returns only the region that changed
+ * @param rect region of the canvas covered by the returned image, in pixels from the top left corner
+ * @return nil without an error after the last frame, the next call starts the animation over
+ */
+-(nullable JXLSystemImage *)nextFrameUpdate:(nonnull CGRect*)rect
+                                    duration:(nullable int*)duration
+                                       error:(NSError *_Nullable * _Nullable)error NS_SWIFT_NOTHROW;
+-(void)playbackStatistics:(nonnull int*)decodedFrames
+               slowFrames:(nonnull int*)slowFrames
+                underruns:(nonnull int*)underruns
+           meanDecodeTime:(nonnull double*)meanDecodeTime
+            maxDecodeTime:(nonnull double*)maxDecodeTime
+        meanFrameDuration:(nonnull double*)meanFrameDuration;
 @end
 
 #endif /* JPEGXL_ANIMATED_DECODER_H */
@@ -26,12 +26,15 @@
 #import <Foundation/Foundation.h>
 #import "CJpegXLAnimatedDecoder.h"
 #import "JxlAnimatedDecoder.hpp"
+#import "JxlAnimatedPlayback.hpp"
+#import "JxlLayerCompositor.hpp"
 #include <vector>
 
 template <typename DataType>
 class JXLDDataWrapper {
 public:
     JXLDDataWrapper(const std::vector<DataType>& src): data(src) {}
+    JXLDDataWrapper(std::vector<DataType>&& src): data(std::move(src)) {}
     const std::vector<DataType> data;
 };
 
@@ -42,11 +45,18 @@ static void JXLDCGData8ProviderReleaseDataCallback(void *info, const void *data,
 
 @implementation CJpegXLAnimatedDecoder {
     JxlAnimatedDecoder* dec;
+    JxlAnimatedPlayback* playback;
+    JxlLayerCompositor* compositor;
+    JxlLayer layer;
     std::vector<uint8_t> mSrc;
+    // Swapped with a ring slot on every playback frame, so the ring gets its buffer back
+    std::vector<uint8_t> playbackPixels;
 }
 
 -(nullable id)initWith:(nonnull NSData*)data error:(NSError * _Nullable *_Nullable)error {
     dec = nullptr;
+    playback = nullptr;
+    compositor = nullptr;
     try {
         const uint8_t* ptr = reinterpret_cast<const uint8_t*>([data bytes]);
         mSrc.resize([data length]);
@@ -64,68 +74,295 @@ static void JXLDCGData8ProviderReleaseDataCallback(void *info, const void *data,
     return self;
 }
 
+-(nullable JXLSystemImage *)createImage:(std::vector<uint8_t>&&)pixels
+                                  width:(int)width
+                                 height:(int)height
+                                  error:(NSError *_Nullable * _Nullable)error {
+    return [self createImage:std::move(pixels) width:width height:height components:4
+              bytesPerSample:1 useFloats:false error:error];
+}
+
+-(nullable JXLSystemImage *)createFrameImage:(std::vector<uint8_t>&&)pixels
+                                       error:(NSError *_Nullable * _Nullable)error {
+    return [self createImage:std::move(pixels) width:dec->getFrameWidth() height:dec->getFrameHeight()
+                  components:dec->getComponents() bytesPerSample:dec->getBytesPerSample()
+                   useFloats:dec->isFloatOutput() error:error];
+}
+
+-(nullable JXLSystemImage *)createImage:(std::vector<uint8_t>&&)pixels
+                                  width:(int)width
+                                 height:(int)height
+                             components:(int)components
+                         bytesPerSample:(int)bytesPerSample
+                              useFloats:(bool)useFloats
+                                  error:(NSError *_Nullable * _Nullable)error {
+    const std::vector<uint8_t>& iccProfile = dec->getIccProfile();
+    auto wrapper = new JXLDDataWrapper<uint8_t>(std::move(pixels));
+
+    CGDataProviderRef provider = CGDataProviderCreateWithData(wrapper,
+                                                              wrapper->data.data(),
+                                                              wrapper->data.size(),
+                                                              JXLDCGData8ProviderReleaseDataCallback);
+    if (!provider) {
+        delete wrapper;
+        *error = [[NSError alloc] initWithDomain:@"JXLCoder"
+                                            code:500
+                                        userInfo:@{ NSLocalizedDescriptionKey: @"CoreGraphics cannot allocate required provider" }];
+        return nullptr;
+    }
+
+    int bitsPerComponent = bytesPerSample * 8;
+    int bitsPerPixel = bitsPerComponent*components;
+    int stride = components * width * bytesPerSample;
+
+    CGColorSpaceRef colorSpace;
+    if (iccProfile.size() > 0) {
+        CFDataRef iccData = CFDataCreate(kCFAllocatorDefault, iccProfile.data(), iccProfile.size());
+        colorSpace = CGColorSpaceCreateWithICCData(iccData);
+        CFRelease(iccData);
+    } else {
+        colorSpace = CGColorSpaceCreateDeviceRGB();
+    }
+
+    if (!colorSpace) {
+        colorSpace = CGColorSpaceCreateDeviceRGB();
+    }
+
+    int flags;
+    if (bytesPerSample == 4) {
+        flags = (int)kCGBitmapByteOrder32Host;
+    } else if (bytesPerSample == 2) {
+        flags = (int)kCGBitmapByteOrder16Host;
+    } else {
+        flags = (int)kCGImageByteOrderDefault;
+    }
+    if (useFloats) {
+        flags |= (int)kCGBitmapFloatComponents;
+    }
+    if (components == 4) {
+        flags |= (int)kCGImageAlphaLast;
+    } else {
+        flags |= (int)kCGImageAlphaNone;
+    }
+
+    CGImageRef imageRef = CGImageCreate(width, height, bitsPerComponent,
+                                        bitsPerPixel,
+                                        stride,
+                                        colorSpace, flags, provider, NULL, false, kCGRenderingIntentDefault);
+    if (!imageRef) {
+        CGDataProviderRelease(provider);
+        CGColorSpaceRelease(colorSpace);
+        *error = [[NSError alloc] initWithDomain:@"JXLCoder"
+                                            code:500
+                                        userInfo:@{ NSLocalizedDescriptionKey: @"CoreGraphics cannot allocate CGImageRef" }];
+        return NULL;
+    }
+    JXLSystemImage *image = nil;
+    #if JXL_PLUGIN_MAC
+    image = [[NSImage alloc] initWithCGImage:imageRef size:CGSizeZero];
+    #else
+    image = [UIImage imageWithCGImage:imageRef scale:1 orientation:UIImageOrientationUp];
+    #endif
+
+    // The image retains what it needs, the pixels are freed together with it
+    CGImageRelease(imageRef);
+    CGDataProviderRelease(provider);
+    CGColorSpaceRelease(colorSpace);
+
+    return image;
+}
+
 -(nullable JXLSystemImage *)get:(int)frame
                             error:(NSError *_Nullable * _Nullable)error {
     try {
         JxlFrame jxlFrame = dec->getFrame(frame);
-        auto wrapper = new JXLDDataWrapper<uint8_t>(jxlFrame.pixels);
-
-        CGDataProviderRef provider = CGDataProviderCreateWithData(wrapper,
-                                                                  wrapper->data.data(),
-                                                                  wrapper->data.size(),
-                                                                  JXLDCGData8ProviderReleaseDataCallback);
-        if (!provider) {
-            delete wrapper;
-            *error = [[NSError alloc] initWithDomain:@"JXLCoder"
-                                                code:500
-                                            userInfo:@{ NSLocalizedDescriptionKey: @"CoreGraphics cannot allocate required provider" }];
-            return nullptr;
-        }
+        return [self createFrameImage:std::move(jxlFrame.pixels) error:error];
+    } catch (AnimatedDecoderError& err) {
+        NSString *str = [[NSString alloc] initWithCString:err.what() encoding:NSUTF8StringEncoding];
+        *error = [[NSError alloc] initWithDomain:@"JpegXLAnimatedDecoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: str }];
+        return nil;
+    } catch (std::bad_alloc &err) {
+        NSString *str = [[NSString alloc] initWithCString:err.what() encoding:NSUTF8StringEncoding];
+        *error = [[NSError alloc] initWithDomain:@"JpegXLAnimatedDecoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: str }];
+        return nil;
+    }
+}
+
+-(void)startPlayback:(int)lookahead memoryLimit:(NSUInteger)memoryLimit {
+    [self stopPlayback];
+    playback = new JxlAnimatedPlayback(*dec, lookahead, static_cast<size_t>(memoryLimit));
+}
+
+-(void)stopPlayback {
+    if (playback) {
+        delete playback;
+        playback = nullptr;
+    }
+    playbackPixels.clear();
+    playbackPixels.shrink_to_fit();
+}
 
-        int bitsPerComponent = sizeof(uint8_t) * 8;
-        int components = 4;
-        int bitsPerPixel = bitsPerComponent*components;
-        int stride = 4 * dec->getWidth() * sizeof(uint8_t);
-
-        CGColorSpaceRef colorSpace;
-        if (jxlFrame.iccProfile.size() > 0) {
-            CFDataRef iccData = CFDataCreate(kCFAllocatorDefault, jxlFrame.iccProfile.data(), jxlFrame.iccProfile.size());
-            colorSpace = CGColorSpaceCreateWithICCData(iccData);
-            CFRelease(iccData);
-        } else {
-            colorSpace = CGColorSpaceCreateDeviceRGB();
+-(nullable JXLSystemImage *)nextPlaybackFrame:(nullable int*)frame
+                                     duration:(nullable int*)duration
+                                        error:(NSError *_Nullable * _Nullable)error {
+    if (!playback) {
+        *error = [[NSError alloc] initWithDomain:@"JpegXLAnimatedDecoder"
+                                            code:500
+                                        userInfo:@{ NSLocalizedDescriptionKey: @"Playback wasn't started" }];
+        return nil;
+    }
+    try {
+        if (!playback->nextFrame(playbackPixels, frame, duration)) {
+            return nil;
         }
+        // The image gets a copy, playbackPixels returns to the ring with the next frame
+        return [self createFrameImage:std::vector<uint8_t>(playbackPixels) error:error];
+    } catch (AnimatedDecoderError& err) {
+        NSString *str = [[NSString alloc] initWithCString:err.what() encoding:NSUTF8StringEncoding];
+        *error = [[NSError alloc] initWithDomain:@"JpegXLAnimatedDecoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: str }];
+        return nil;
+    } catch (std::bad_alloc &err) {
+        NSString *str = [[NSString alloc] initWithCString:err.what() encoding:NSUTF8StringEncoding];
+        *error = [[NSError alloc] initWithDomain:@"JpegXLAnimatedDecoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: str }];
+        return nil;
+    }
+}
+
+-(void)playbackStatistics:(nonnull int*)decodedFrames
+               slowFrames:(nonnull int*)slowFrames
+                underruns:(nonnull int*)underruns
+           meanDecodeTime:(nonnull double*)meanDecodeTime
+            maxDecodeTime:(nonnull double*)maxDecodeTime
+        meanFrameDuration:(nonnull double*)meanFrameDuration {
+    JxlPlaybackStatistics statistics;
+    if (playback) {
+        statistics = playback->getStatistics();
+    }
+    *decodedFrames = statistics.decodedFrames;
+    *slowFrames = statistics.slowFrames;
+    *underruns = statistics.underruns;
+    *meanDecodeTime = statistics.meanDecodeTime;
+    *maxDecodeTime = statistics.maxDecodeTime;
+    *meanFrameDuration = statistics.meanFrameDuration;
+}
 
-        if (!colorSpace) {
-            colorSpace = CGColorSpaceCreateDeviceRGB();
+-(nullable JXLSystemImage *)nextFrameUpdate:(nonnull CGRect*)rect
+                                    duration:(nullable int*)duration
+                                       error:(NSError *_Nullable * _Nullable)error {
+    try {
+        if (!compositor) {
+            compositor = new JxlLayerCompositor(dec->getWidth(), dec->getHeight());
+        }
+        JxlRect dirty;
+        int frameTime = 0;
+        for (;;) {
+            if (!dec->nextLayer(layer)) {
+                compositor->reset();
+                return nil;
+            }
+            dirty = dirty.united(compositor->apply(layer));
+            frameTime += layer.duration;
+            if (layer.endsFrame) {
+                break;
+            }
+        }
+        if (duration) {
+            *duration = frameTime;
         }
+        if (dirty.empty()) {
+            // Nothing has changed, keep showing the previous frame as is
+            dirty = { .x = 0, .y = 0, .width = 1, .height = 1 };
+        }
+        *rect = CGRectMake(dirty.x, dirty.y, dirty.width, dirty.height);
 
-        int flags;
-        flags = (int)kCGImageByteOrderDefault;
-        if (components == 4) {
-            flags |= (int)kCGImageAlphaLast;
-        } else {
-            flags |= (int)kCGImageAlphaNone;
+        const std::vector<uint8_t>& canvas = compositor->getCanvas();
+        const size_t stride = static_cast<size_t>(dec->getWidth()) * 4;
+        const size_t rowSize = static_cast<size_t>(dirty.width) * 4;
+        std::vector<uint8_t> pixels(rowSize * dirty.height);
+        for (int y = 0; y < dirty.height; ++y) {
+            const uint8_t* src = canvas.data() + (dirty.y + y) * stride + static_cast<size_t>(dirty.x) * 4;
+            std::copy(src, src + rowSize, pixels.data() + y * rowSize);
         }
+        return [self createImage:std::move(pixels) width:dirty.width height:dirty.height error:error];
+    } catch (AnimatedDecoderError& err) {
+        NSString *str = [[NSString alloc] initWithCString:err.what() encoding:NSUTF8StringEncoding];
+        *error = [[NSError alloc] initWithDomain:@"JpegXLAnimatedDecoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: str }];
+        return nil;
+    } catch (std::bad_alloc &err) {
+        NSString *str = [[NSString alloc] initWithCString:err.what() encoding:NSUTF8StringEncoding];
+        *error = [[NSError alloc] initWithDomain:@"JpegXLAnimatedDecoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: str }];
+        return nil;
+    }
+}
+
+-(BOOL)setTargetSize:(CGSize)size error:(NSError *_Nullable * _Nullable)error {
+    [self stopPlayback];
+    try {
+        dec->setTargetSize(static_cast<uint32_t>(std::max(size.width, 0.0)),
+                           static_cast<uint32_t>(std::max(size.height, 0.0)));
+    } catch (AnimatedDecoderError& err) {
+        NSString *str = [[NSString alloc] initWithCString:err.what() encoding:NSUTF8StringEncoding];
+        *error = [[NSError alloc] initWithDomain:@"JpegXLAnimatedDecoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: str }];
+        return NO;
+    }
+    return YES;
+}
+
+-(BOOL)setPixelFormat:(JXLPreferredPixelFormat)pixelFormat
+              rgbOnly:(BOOL)rgbOnly
+                error:(NSError *_Nullable * _Nullable)error {
+    [self stopPlayback];
+    JxlDecodingPixelFormat jxlPixelFormat;
+    switch (pixelFormat) {
+        case kOptimal:
+            jxlPixelFormat = optimal;
+            break;
+        case kR8:
+            jxlPixelFormat = r8;
+            break;
+        case kR16:
+            jxlPixelFormat = r16;
+            break;
+        case kFloat16:
+            jxlPixelFormat = float16;
+            break;
+        case kFloat32:
+            jxlPixelFormat = float32;
+            break;
+    }
+    try {
+        dec->setOutputFormat(jxlPixelFormat, rgbOnly);
+    } catch (AnimatedDecoderError& err) {
+        NSString *str = [[NSString alloc] initWithCString:err.what() encoding:NSUTF8StringEncoding];
+        *error = [[NSError alloc] initWithDomain:@"JpegXLAnimatedDecoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: str }];
+        return NO;
+    }
+    return YES;
+}
 
-        CGImageRef imageRef = CGImageCreate(dec->getWidth(), dec->getHeight(), bitsPerComponent,
-                                            bitsPerPixel,
-                                            stride,
-                                            colorSpace, flags, provider, NULL, false, kCGRenderingIntentDefault);
-        if (!imageRef) {
-            *error = [[NSError alloc] initWithDomain:@"JXLCoder"
-                                                code:500
-                                            userInfo:@{ NSLocalizedDescriptionKey: @"CoreGraphics cannot allocate CGImageRef" }];
-            return NULL;
+-(nullable NSArray<JXLSystemImage *> *)exportFrames:(NSRange)range
+                                          numThreads:(int)numThreads
+                                               error:(NSError *_Nullable * _Nullable)error {
+    try {
+        const size_t frameSize = dec->getFrameSize();
+        std::vector<std::vector<uint8_t>> pixels(range.length);
+        std::vector<uint8_t*> frames(range.length);
+        for (NSUInteger i = 0; i < range.length; ++i) {
+            pixels[i].resize(frameSize);
+            frames[i] = pixels[i].data();
         }
-        JXLSystemImage *image = nil;
-    #if JXL_PLUGIN_MAC
-        image = [[NSImage alloc] initWithCGImage:imageRef size:CGSizeZero];
-    #else
-        image = [UIImage imageWithCGImage:imageRef scale:1 orientation:UIImageOrientationUp];
-    #endif
+        dec->exportFrames(static_cast<int>(range.location), static_cast<int>(range.length),
+                          frames.data(), nullptr, numThreads);
 
-        return image;
+        NSMutableArray<JXLSystemImage *> *images = [[NSMutableArray alloc] initWithCapacity:range.length];
+        for (NSUInteger i = 0; i < range.length; ++i) {
+            JXLSystemImage *image = [self createFrameImage:std::move(pixels[i]) error:error];
+            if (!image) {
+                return nil;
+            }
+            [images addObject:image];
+        }
+        return images;
     } catch (AnimatedDecoderError& err) {
         NSString *str = [[NSString alloc] initWithCString:err.what() encoding:NSUTF8StringEncoding];
         *error = [[NSError alloc] initWithDomain:@"JpegXLAnimatedDecoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: str }];
@@ -137,8 +374,33 @@ static void JXLDCGData8ProviderReleaseDataCallback(void *info, const void *data,
     }
 }
 
+// Getters below scan frame headers lazily, a corrupt header is reported with a sentinel value
 -(NSUInteger)framesCount {
-    return static_cast<NSUInteger>(dec->getNumberOfFrames());
+    try {
+        return static_cast<NSUInteger>(dec->getNumberOfFrames());
+    } catch (AnimatedDecoderError& err) {
+        return 0;
+    } catch (std::bad_alloc& err) {
+        return 0;
+    }
+}
+
+-(int)totalDuration {
+    try {
+        return static_cast<int>(dec->getTotalDuration());
+    } catch (AnimatedDecoderError& err) {
+        return -1;
+    } catch (std::bad_alloc& err) {
+        return -1;
+    }
+}
+
+-(void)completeScanInBackground {
+    dec->completeScanInBackground();
+}
+
+-(BOOL)isScanComplete {
+    return dec->isScanComplete() ? YES : NO;
 }
 
 -(int)loopCount {
@@ -146,10 +408,59 @@ static void JXLDCGData8ProviderReleaseDataCallback(void *info, const void *data,
 }
 
 -(int)frameDuration:(int)frame {
-    return static_cast<int>(dec->getFrameDuration(frame));
+    try {
+        return static_cast<int>(dec->getFrameDuration(frame));
+    } catch (AnimatedDecoderError& err) {
+        return -1;
+    } catch (std::bad_alloc& err) {
+        return -1;
+    }
+}
+
+-(void)timebaseNumerator:(nonnull uint32_t*)numerator denominator:(nonnull uint32_t*)denominator {
+    dec->getTimebase(numerator, denominator);
 }
 
--(void)deinit {
+-(uint32_t)frameTicks:(int)frame {
+    try {
+        return dec->getFrameTicks(frame);
+    } catch (AnimatedDecoderError& err) {
+        return 0;
+    } catch (std::bad_alloc& err) {
+        return 0;
+    }
+}
+
+-(BOOL)hasTimecodes {
+    return dec->hasTimecodes() ? YES : NO;
+}
+
+-(uint32_t)frameTimecode:(int)frame {
+    try {
+        return dec->getFrameTimecode(frame);
+    } catch (AnimatedDecoderError& err) {
+        return 0;
+    } catch (std::bad_alloc& err) {
+        return 0;
+    }
+}
+
+-(int)frameIndexAtTime:(double)seconds {
+    try {
+        return dec->getFrameAtTime(seconds);
+    } catch (AnimatedDecoderError& err) {
+        return -1;
+    } catch (std::bad_alloc& err) {
+        return -1;
+    }
+}
+
+-(void)dealloc {
+    [self stopPlayback];
+    if (compositor) {
+        delete compositor;
+        compositor = nullptr;
+    }
     if (dec) {
         delete dec;
         dec = nullptr;
@@ -27,7 +27,47 @@
 #define CANIMATED_ENCODER_H
 
 #import "JXLSystemImage.hpp"
+#import "JXLEncoderOptions.h"
 #import <Foundation/Foundation.h>
+#import <CoreVideo/CoreVideo.h>
+
+typedef NS_ENUM(NSInteger, JXLYUVMatrix) {
+    kYUVMatrixBT601 NS_SWIFT_NAME(bt601),
+    kYUVMatrixBT709 NS_SWIFT_NAME(bt709),
+    kYUVMatrixBT2020 NS_SWIFT_NAME(bt2020)
+};
+
+/// Transfer function the animation is tagged with, automatic is sRGB for integer samples and linear for floats
+typedef NS_ENUM(NSInteger, JXLTransferFunction) {
+    kTransferAutomatic NS_SWIFT_NAME(automatic),
+    kTransferSRGB NS_SWIFT_NAME(sRGB),
+    kTransferLinear NS_SWIFT_NAME(linear),
+    /// BT.2100 PQ, frames must be added as pixels
+    kTransferPQ NS_SWIFT_NAME(pq),
+    /// BT.2100 HLG, frames must be added as pixels
+    kTransferHLG NS_SWIFT_NAME(hlg)
+};
+
+/**
+ * Per frame overrides of the animation settings, every property left at -1 keeps the animation value
+ */
+@interface JXLAnimationFrameOptions : NSObject
+/// Butteraugli distance of the frame, 0...25
+@property (nonatomic) float distance;
+/// 1...9
+@property (nonatomic) NSInteger effort;
+/// 0 or 1, lossless frames require an animation created lossless
+@property (nonatomic) NSInteger lossless;
+/// Encodes the whole canvas without building on the previous frame
+@property (nonatomic) BOOL keyframe;
+/// NO when no later frame builds on this one, defaults to YES
+@property (nonatomic) BOOL saveAsReference;
+@property (nonatomic, strong, nullable) NSString *name;
+/// SMPTE timecode 0xHHMMSSFF, written only when the animation was created with timecodes
+@property (nonatomic) uint32_t timecode;
+
+-(nonnull instancetype)init;
+@end
 
 @interface CJpegXLAnimatedEncoder : NSObject
 -(nullable id)initWith:(int)width height:(int)height numLoops:(int)numLoops colorSpace:(JXLColorSpace)colorSpace
@@ -35,8 +75,66 @@
                 effort:(int)effort
                quality:(int)quality
          decodingSpeed:(JXLEncoderDecodingSpeed)decodingSpeed
+               options:(nullable JXLEncoderOptions*)options
+                 error:(NSError * _Nullable *_Nullable)error;
+/// pixelFormat selects the sample type stored in the animation, optimal is treated as r8
+-(nullable id)initWith:(int)width height:(int)height numLoops:(int)numLoops colorSpace:(JXLColorSpace)colorSpace
+     compressionOption:(JXLCompressionOption)compressionOption
+                effort:(int)effort
+               quality:(int)quality
+         decodingSpeed:(JXLEncoderDecodingSpeed)decodingSpeed
+           pixelFormat:(JXLPreferredPixelFormat)pixelFormat
+               options:(nullable JXLEncoderOptions*)options
+                 error:(NSError * _Nullable *_Nullable)error;
+/// Frame durations are counted in ticks of timebaseDenominator / timebaseNumerator seconds, 1000 / 1 keeps milliseconds
+-(nullable id)initWith:(int)width height:(int)height numLoops:(int)numLoops colorSpace:(JXLColorSpace)colorSpace
+     compressionOption:(JXLCompressionOption)compressionOption
+                effort:(int)effort
+               quality:(int)quality
+         decodingSpeed:(JXLEncoderDecodingSpeed)decodingSpeed
+           pixelFormat:(JXLPreferredPixelFormat)pixelFormat
+     timebaseNumerator:(uint32_t)timebaseNumerator
+   timebaseDenominator:(uint32_t)timebaseDenominator
+             timecodes:(BOOL)timecodes
+               options:(nullable JXLEncoderOptions*)options
+                 error:(NSError * _Nullable *_Nullable)error;
+/// Platform images are converted from sRGB to the transfer function, linear animations do not accept YUV frames
+-(nullable id)initWith:(int)width height:(int)height numLoops:(int)numLoops colorSpace:(JXLColorSpace)colorSpace
+     compressionOption:(JXLCompressionOption)compressionOption
+                effort:(int)effort
+               quality:(int)quality
+         decodingSpeed:(JXLEncoderDecodingSpeed)decodingSpeed
+           pixelFormat:(JXLPreferredPixelFormat)pixelFormat
+     timebaseNumerator:(uint32_t)timebaseNumerator
+   timebaseDenominator:(uint32_t)timebaseDenominator
+             timecodes:(BOOL)timecodes
+      transferFunction:(JXLTransferFunction)transferFunction
+               options:(nullable JXLEncoderOptions*)options
                  error:(NSError * _Nullable *_Nullable)error;
 -(nullable void*)addFrame:(nonnull JXLSystemImage *)platformImage duration:(int)duration error:(NSError * _Nullable *_Nullable)error;
+-(nullable void*)addFrame:(nonnull JXLSystemImage *)platformImage duration:(int)duration
+                  options:(nullable JXLAnimationFrameOptions*)options
+                    error:(NSError * _Nullable *_Nullable)error;
+/// Interleaved samples in the animation pixel format, RGB or RGBA with unpremultiplied alpha, rows tightly packed
+-(nullable void*)addFramePixels:(nonnull NSData *)pixels duration:(int)duration
+                        options:(nullable JXLAnimationFrameOptions*)options
+                          error:(NSError * _Nullable *_Nullable)error;
+/// Accepts 420v, 420f, y420, f420, x420 and xf20 buffers, range is taken from the pixel format type
+-(nullable void*)addFramePixelBuffer:(nonnull CVPixelBufferRef)pixelBuffer matrix:(JXLYUVMatrix)matrix
+                            duration:(int)duration
+                             options:(nullable JXLAnimationFrameOptions*)options
+                               error:(NSError * _Nullable *_Nullable)error;
+-(void)setCropChangedRegions:(bool)enabled;
+-(void)setCoalesceDuplicates:(bool)enabled;
+-(void)startAsync:(int)queueSize;
+-(BOOL)setOutputHandler:(nonnull BOOL (^)(NSData * _Nonnull chunk))handler error:(NSError * _Nullable *_Nullable)error;
+/// Converts a GIF or APNG animation into JXL, frames are streamed one at a time into the encoder
++(nullable NSData*)importAnimation:(nonnull NSData*)data
+                 compressionOption:(JXLCompressionOption)compressionOption
+                            effort:(int)effort
+                           quality:(int)quality
+                     decodingSpeed:(JXLEncoderDecodingSpeed)decodingSpeed
+                             error:(NSError * _Nullable *_Nullable)error;
 -(nullable NSData*)finish:(NSError * _Nullable *_Nullable)error;
 @end
 
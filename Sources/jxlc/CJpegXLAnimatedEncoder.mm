@@ -26,8 +26,12 @@
 #import <Foundation/Foundation.h>
 #import "CJpegXLAnimatedEncoder.h"
 #import "JxlAnimatedEncoder.hpp"
+#import "JxlAnimationImporter.hpp"
 #import "JxlDefinitions.h"
 #import "RgbRgbaConverter.hpp"
+#include <algorithm>
+#include <cmath>
+#include "half.hpp"
 
 class JCDataWrapper {
 public:
@@ -41,6 +45,98 @@ public:
     std::vector<uint8_t> data;
 };
 
+static JxlAnimatedFrameOptions JXLMakeFrameOptions(JXLAnimationFrameOptions* _Nullable options) {
+    JxlAnimatedFrameOptions frameOptions;
+    if (options) {
+        frameOptions.distance = options.distance;
+        frameOptions.effort = (int)options.effort;
+        frameOptions.lossless = (int)options.lossless;
+        frameOptions.keyframe = options.keyframe;
+        frameOptions.saveAsReference = options.saveAsReference;
+        frameOptions.timecode = options.timecode;
+        if (options.name) {
+            frameOptions.name = std::string([options.name UTF8String]);
+        }
+    }
+    return frameOptions;
+}
+
+static float JXLSRGBToLinear(float value) {
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+/**
+ * Platform images are always drawn with 8 bits of sRGB, high bit depth or linear animations receive them
+ * widened and, when the animation is linear, with the color channels linearized
+ */
+static std::vector<uint8_t> JXLWidenSamples(const std::vector<uint8_t>& src, JxlEncodingPixelFormat format,
+                                            bool linearize, int channels, bool hasAlpha) {
+    if (format == er8 && !linearize) {
+        return src;
+    }
+    float table[256];
+    for (int i = 0; i < 256; ++i) {
+        table[i] = linearize ? JXLSRGBToLinear(static_cast<float>(i) / 255.f) : static_cast<float>(i) / 255.f;
+    }
+    auto sample = [&](size_t i) -> float {
+        const bool alpha = hasAlpha && (i % channels) == static_cast<size_t>(channels - 1);
+        return alpha ? static_cast<float>(src[i]) / 255.f : table[src[i]];
+    };
+    std::vector<uint8_t> dst;
+    switch (format) {
+        case er8: {
+            dst.resize(src.size());
+            for (size_t i = 0; i < src.size(); ++i) {
+                dst[i] = static_cast<uint8_t>(std::lround(sample(i) * 255.f));
+            }
+            break;
+        }
+        case er16: {
+            dst.resize(src.size() * sizeof(uint16_t));
+            auto samples = reinterpret_cast<uint16_t*>(dst.data());
+            for (size_t i = 0; i < src.size(); ++i) {
+                samples[i] = static_cast<uint16_t>(std::lround(sample(i) * 65535.f));
+            }
+            break;
+        }
+        case efloat16: {
+            dst.resize(src.size() * sizeof(uint16_t));
+            auto samples = reinterpret_cast<half_float::half*>(dst.data());
+            for (size_t i = 0; i < src.size(); ++i) {
+                samples[i] = half_float::half(sample(i));
+            }
+            break;
+        }
+        case efloat32: {
+            dst.resize(src.size() * sizeof(float));
+            auto samples = reinterpret_cast<float*>(dst.data());
+            for (size_t i = 0; i < src.size(); ++i) {
+                samples[i] = sample(i);
+            }
+            break;
+        }
+    }
+    return dst;
+}
+
+@implementation JXLAnimationFrameOptions
+
+-(nonnull instancetype)init {
+    self = [super init];
+    if (self) {
+        _distance = -1;
+        _effort = -1;
+        _lossless = -1;
+        _keyframe = NO;
+        _saveAsReference = YES;
+        _name = nil;
+        _timecode = 0;
+    }
+    return self;
+}
+
+@end
+
 @implementation CJpegXLAnimatedEncoder {
     JxlAnimatedEncoder* enc;
 }
@@ -52,8 +148,97 @@ public:
                 effort:(int)effort
                quality:(int)quality 
          decodingSpeed:(JXLEncoderDecodingSpeed)decodingSpeed
+               options:(nullable JXLEncoderOptions*)options
+                 error:(NSError * _Nullable *_Nullable)error {
+    return [self initWith:width height:height numLoops:numLoops colorSpace:colorSpace
+        compressionOption:compressionOption effort:effort quality:quality decodingSpeed:decodingSpeed
+              pixelFormat:kR8 options:options error:error];
+}
+
+-(nullable id)initWith:(int)width height:(int)height
+              numLoops:(int)numLoops
+            colorSpace:(JXLColorSpace)colorSpace
+     compressionOption:(JXLCompressionOption)compressionOption
+                effort:(int)effort
+               quality:(int)quality
+         decodingSpeed:(JXLEncoderDecodingSpeed)decodingSpeed
+           pixelFormat:(JXLPreferredPixelFormat)pixelFormat
+               options:(nullable JXLEncoderOptions*)options
+                 error:(NSError * _Nullable *_Nullable)error {
+    return [self initWith:width height:height numLoops:numLoops colorSpace:colorSpace
+        compressionOption:compressionOption effort:effort quality:quality decodingSpeed:decodingSpeed
+              pixelFormat:pixelFormat timebaseNumerator:1000 timebaseDenominator:1 timecodes:NO
+                  options:options error:error];
+}
+
+-(nullable id)initWith:(int)width height:(int)height
+              numLoops:(int)numLoops
+            colorSpace:(JXLColorSpace)colorSpace
+     compressionOption:(JXLCompressionOption)compressionOption
+                effort:(int)effort
+               quality:(int)quality
+         decodingSpeed:(JXLEncoderDecodingSpeed)decodingSpeed
+           pixelFormat:(JXLPreferredPixelFormat)pixelFormat
+     timebaseNumerator:(uint32_t)timebaseNumerator
+   timebaseDenominator:(uint32_t)timebaseDenominator
+             timecodes:(BOOL)timecodes
+               options:(nullable JXLEncoderOptions*)options
+                 error:(NSError * _Nullable *_Nullable)error {
+    return [self initWith:width height:height numLoops:numLoops colorSpace:colorSpace
+        compressionOption:compressionOption effort:effort quality:quality decodingSpeed:decodingSpeed
+              pixelFormat:pixelFormat timebaseNumerator:timebaseNumerator timebaseDenominator:timebaseDenominator
+                timecodes:timecodes transferFunction:kTransferAutomatic options:options error:error];
+}
+
+-(nullable id)initWith:(int)width height:(int)height
+              numLoops:(int)numLoops
+            colorSpace:(JXLColorSpace)colorSpace
+     compressionOption:(JXLCompressionOption)compressionOption
+                effort:(int)effort
+               quality:(int)quality
+         decodingSpeed:(JXLEncoderDecodingSpeed)decodingSpeed
+           pixelFormat:(JXLPreferredPixelFormat)pixelFormat
+     timebaseNumerator:(uint32_t)timebaseNumerator
+   timebaseDenominator:(uint32_t)timebaseDenominator
+             timecodes:(BOOL)timecodes
+      transferFunction:(JXLTransferFunction)transferFunction
+               options:(nullable JXLEncoderOptions*)options
                  error:(NSError * _Nullable *_Nullable)error {
     enc = nullptr;
+    JxlEncodingPixelFormat jPixelFormat = er8;
+    switch (pixelFormat) {
+        case kOptimal:
+        case kR8:
+            jPixelFormat = er8;
+            break;
+        case kR16:
+            jPixelFormat = er16;
+            break;
+        case kFloat16:
+            jPixelFormat = efloat16;
+            break;
+        case kFloat32:
+            jPixelFormat = efloat32;
+            break;
+    }
+    JxlEncodingTransfer jTransfer = etAutomatic;
+    switch (transferFunction) {
+        case kTransferAutomatic:
+            jTransfer = etAutomatic;
+            break;
+        case kTransferSRGB:
+            jTransfer = etSRGB;
+            break;
+        case kTransferLinear:
+            jTransfer = etLinear;
+            break;
+        case kTransferPQ:
+            jTransfer = etPQ;
+            break;
+        case kTransferHLG:
+            jTransfer = etHLG;
+            break;
+    }
     JxlPixelType jColorspace;
     JxlCompressionOption jCompressionOption;
 
@@ -64,6 +249,10 @@ public:
         case kRGBA:
             jColorspace = rgba;
             break;
+        case kAutomatic:
+            // Frames are not known upfront, so the automatic layout keeps every channel
+            jColorspace = rgba;
+            break;
     }
 
     switch (compressionOption) {
@@ -76,7 +265,12 @@ public:
     }
 
     try {
-        enc = new JxlAnimatedEncoder(width, height, jColorspace, er8, jCompressionOption, numLoops, quality, effort, (int)decodingSpeed);
+        JxlAnimationTiming timing;
+        timing.tpsNumerator = timebaseNumerator;
+        timing.tpsDenominator = timebaseDenominator;
+        timing.haveTimecodes = timecodes;
+        enc = new JxlAnimatedEncoder(width, height, jColorspace, jPixelFormat, jCompressionOption, numLoops, quality, effort, (int)decodingSpeed,
+                                     options ? [options jxlOptions] : jxlcoder::JxlEncoderOptions(), timing, jTransfer);
     } catch (AnimatedEncoderError& err) {
         NSString *str = [[NSString alloc] initWithCString:err.what() encoding:NSUTF8StringEncoding];
         *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: str }];
@@ -90,6 +284,12 @@ public:
 }
 
 -(nullable void*)addFrame:(nonnull JXLSystemImage *)platformImage duration:(int)duration error:(NSError * _Nullable *_Nullable)error {
+    return [self addFrame:platformImage duration:duration options:nil error:error];
+}
+
+-(nullable void*)addFrame:(nonnull JXLSystemImage *)platformImage duration:(int)duration
+                  options:(nullable JXLAnimationFrameOptions*)options
+                    error:(NSError * _Nullable *_Nullable)error {
     try {
         int width, height;
         std::vector<uint8_t> buf;
@@ -114,19 +314,214 @@ public:
             buf = resizedVector;
         }
 
-        enc->addFrame(buf, duration);
+        const JxlEncodingTransfer transfer = enc->getTransfer();
+        if (transfer == etPQ || transfer == etHLG) {
+            *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500
+                                            userInfo:@{ NSLocalizedDescriptionKey: @"PQ and HLG animations take HDR pixels, not platform images" }];
+            return nil;
+        }
+        if (enc->getEncodingPixelFormat() != er8 || transfer == etLinear) {
+            const JxlPixelType pixelType = enc->getJxlPixelType();
+            const int channels = pixelType == rgba ? 4 : (pixelType == rgb ? 3 : (pixelType == grayAlpha ? 2 : 1));
+            buf = JXLWidenSamples(buf, enc->getEncodingPixelFormat(), transfer == etLinear,
+                                  channels, pixelType == rgba || pixelType == grayAlpha);
+        }
+
+        enc->addFrame(std::move(buf), duration, JXLMakeFrameOptions(options));
+    } catch (AnimatedEncoderError& err) {
+        NSString *str = [[NSString alloc] initWithCString:err.what() encoding:NSUTF8StringEncoding];
+        *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: str }];
+        return nil;
+    } catch (std::bad_alloc &err) {
+        NSString *str = [[NSString alloc] initWithCString:err.what() encoding:NSUTF8StringEncoding];
+        *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: str }];
+        return nil;
+    }
+    return reinterpret_cast<void*>(enc);
+}
+
+-(nullable void*)addFramePixels:(nonnull NSData *)pixels duration:(int)duration
+                        options:(nullable JXLAnimationFrameOptions*)options
+                          error:(NSError * _Nullable *_Nullable)error {
+    try {
+        if (pixels.length != enc->getFrameSize()) {
+            *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500
+                                            userInfo:@{ NSLocalizedDescriptionKey: @"Pixels size doesn't match animation size and pixel format" }];
+            return nil;
+        }
+        auto bytes = reinterpret_cast<const uint8_t*>(pixels.bytes);
+        std::vector<uint8_t> buf(bytes, bytes + pixels.length);
+        enc->addFrame(std::move(buf), duration, JXLMakeFrameOptions(options));
+    } catch (AnimatedEncoderError& err) {
+        NSString *str = [[NSString alloc] initWithCString:err.what() encoding:NSUTF8StringEncoding];
+        *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: str }];
+        return nil;
+    } catch (std::bad_alloc &err) {
+        NSString *str = [[NSString alloc] initWithCString:err.what() encoding:NSUTF8StringEncoding];
+        *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: str }];
+        return nil;
+    }
+    return reinterpret_cast<void*>(enc);
+}
+
+-(nullable void*)addFramePixelBuffer:(nonnull CVPixelBufferRef)pixelBuffer matrix:(JXLYUVMatrix)matrix
+                            duration:(int)duration
+                             options:(nullable JXLAnimationFrameOptions*)options
+                               error:(NSError * _Nullable *_Nullable)error {
+    jxlcoder::JxlYuvFrame frame;
+    switch (matrix) {
+        case kYUVMatrixBT601:
+            frame.matrix = jxlcoder::JXL_YUV_BT601;
+            break;
+        case kYUVMatrixBT709:
+            frame.matrix = jxlcoder::JXL_YUV_BT709;
+            break;
+        case kYUVMatrixBT2020:
+            frame.matrix = jxlcoder::JXL_YUV_BT2020;
+            break;
+    }
+
+    switch (CVPixelBufferGetPixelFormatType(pixelBuffer)) {
+        case kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange:
+            frame.layout = jxlcoder::JXL_YUV_NV12;
+            frame.range = jxlcoder::JXL_YUV_RANGE_LIMITED;
+            break;
+        case kCVPixelFormatType_420YpCbCr8BiPlanarFullRange:
+            frame.layout = jxlcoder::JXL_YUV_NV12;
+            frame.range = jxlcoder::JXL_YUV_RANGE_FULL;
+            break;
+        case kCVPixelFormatType_420YpCbCr8Planar:
+            frame.layout = jxlcoder::JXL_YUV_I420;
+            frame.range = jxlcoder::JXL_YUV_RANGE_LIMITED;
+            break;
+        case kCVPixelFormatType_420YpCbCr8PlanarFullRange:
+            frame.layout = jxlcoder::JXL_YUV_I420;
+            frame.range = jxlcoder::JXL_YUV_RANGE_FULL;
+            break;
+        case kCVPixelFormatType_420YpCbCr10BiPlanarVideoRange:
+            frame.layout = jxlcoder::JXL_YUV_P010;
+            frame.range = jxlcoder::JXL_YUV_RANGE_LIMITED;
+            break;
+        case kCVPixelFormatType_420YpCbCr10BiPlanarFullRange:
+            frame.layout = jxlcoder::JXL_YUV_P010;
+            frame.range = jxlcoder::JXL_YUV_RANGE_FULL;
+            break;
+        default:
+            *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500
+                                            userInfo:@{ NSLocalizedDescriptionKey: @"Unsupported pixel buffer format" }];
+            return nil;
+    }
+
+    if ((int)CVPixelBufferGetWidth(pixelBuffer) != enc->getWidth()
+        || (int)CVPixelBufferGetHeight(pixelBuffer) != enc->getHeight()) {
+        *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500
+                                        userInfo:@{ NSLocalizedDescriptionKey: @"Width and height of all images must be equal" }];
+        return nil;
+    }
+
+    if (CVPixelBufferLockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly) != kCVReturnSuccess) {
+        *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500
+                                        userInfo:@{ NSLocalizedDescriptionKey: @"Cannot lock pixel buffer" }];
+        return nil;
+    }
+
+    frame.y = reinterpret_cast<const uint8_t*>(CVPixelBufferGetBaseAddressOfPlane(pixelBuffer, 0));
+    frame.yStride = CVPixelBufferGetBytesPerRowOfPlane(pixelBuffer, 0);
+    frame.u = reinterpret_cast<const uint8_t*>(CVPixelBufferGetBaseAddressOfPlane(pixelBuffer, 1));
+    frame.uStride = CVPixelBufferGetBytesPerRowOfPlane(pixelBuffer, 1);
+    if (frame.layout == jxlcoder::JXL_YUV_I420) {
+        frame.v = reinterpret_cast<const uint8_t*>(CVPixelBufferGetBaseAddressOfPlane(pixelBuffer, 2));
+        frame.vStride = CVPixelBufferGetBytesPerRowOfPlane(pixelBuffer, 2);
+    }
+
+    try {
+        enc->addYuvFrame(frame, duration, JXLMakeFrameOptions(options));
     } catch (AnimatedEncoderError& err) {
+        CVPixelBufferUnlockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly);
         NSString *str = [[NSString alloc] initWithCString:err.what() encoding:NSUTF8StringEncoding];
         *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: str }];
         return nil;
     } catch (std::bad_alloc &err) {
+        CVPixelBufferUnlockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly);
         NSString *str = [[NSString alloc] initWithCString:err.what() encoding:NSUTF8StringEncoding];
         *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: str }];
         return nil;
     }
+    CVPixelBufferUnlockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly);
     return reinterpret_cast<void*>(enc);
 }
 
+-(void)setCropChangedRegions:(bool)enabled {
+    enc->setCropChangedRegions(enabled);
+}
+
+-(void)setCoalesceDuplicates:(bool)enabled {
+    enc->setCoalesceDuplicates(enabled);
+}
+
+-(void)startAsync:(int)queueSize {
+    enc->startAsync(static_cast<size_t>(std::max(queueSize, 1)));
+}
+
+-(BOOL)setOutputHandler:(nonnull BOOL (^)(NSData * _Nonnull chunk))handler error:(NSError * _Nullable *_Nullable)error {
+    try {
+        enc->setOutputSink([handler](const uint8_t* data, size_t size) -> bool {
+            return handler([[NSData alloc] initWithBytes:data length:size]) == YES;
+        });
+    } catch (AnimatedEncoderError& err) {
+        NSString *str = [[NSString alloc] initWithCString:err.what() encoding:NSUTF8StringEncoding];
+        *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: str }];
+        return NO;
+    }
+    return YES;
+}
+
++(nullable NSData*)importAnimation:(nonnull NSData*)data
+                 compressionOption:(JXLCompressionOption)compressionOption
+                            effort:(int)effort
+                           quality:(int)quality
+                     decodingSpeed:(JXLEncoderDecodingSpeed)decodingSpeed
+                             error:(NSError * _Nullable *_Nullable)error {
+    JxlCompressionOption jCompressionOption = loosy;
+    switch (compressionOption) {
+        case kLoseless:
+            jCompressionOption = loseless;
+            break;
+        case kLossy:
+            jCompressionOption = loosy;
+            break;
+    }
+
+    JCDataWrapper* wrapper = new JCDataWrapper;
+    try {
+        JxlAnimationImporter importer(reinterpret_cast<const uint8_t*>(data.bytes), data.length);
+        JxlAnimatedEncoder encoder(importer.getWidth(), importer.getHeight(), rgba, er8, jCompressionOption,
+                                   importer.getLoopCount(), quality, effort, (int)decodingSpeed);
+        importer.importInto(encoder);
+        encoder.encode(wrapper->data);
+    } catch (AnimationImportError& err) {
+        delete wrapper;
+        NSString *str = [[NSString alloc] initWithCString:err.what() encoding:NSUTF8StringEncoding];
+        *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: str }];
+        return nil;
+    } catch (AnimatedEncoderError& err) {
+        delete wrapper;
+        NSString *str = [[NSString alloc] initWithCString:err.what() encoding:NSUTF8StringEncoding];
+        *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: str }];
+        return nil;
+    } catch (std::bad_alloc &err) {
+        delete wrapper;
+        NSString *str = [[NSString alloc] initWithCString:err.what() encoding:NSUTF8StringEncoding];
+        *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: str }];
+        return nil;
+    }
+    return [[NSMutableData alloc] initWithBytesNoCopy:wrapper->data.data()
+                                               length:wrapper->data.size()
+                                          deallocator:^(void * _Nonnull bytes, NSUInteger length) {
+        delete wrapper;
+    }];
+}
+
 -(nullable NSData*)finish:(NSError * _Nullable *_Nullable)error {
     JCDataWrapper* wrapper = new JCDataWrapper;
     try {
@@ -150,7 +545,8 @@ public:
     }
 }
 
--(void)deinit {
+-(void)dealloc {
+    // Deleting the encoder stops the async worker and drops the frames still queued
     if (enc) {
         delete enc;
         enc = nullptr;
@@ -0,0 +1,89 @@
+//
+//  JXLEncoderOptions.h
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#ifndef JXLEncoderOptions_h
+#define JXLEncoderOptions_h
+
+#import <Foundation/Foundation.h>
+
+#ifdef __cplusplus
+#include "JxlEncoderOptions.hpp"
+#include "JxlEncoderMetadata.hpp"
+#endif
+
+typedef NS_ENUM(NSInteger, JXLEncoderPreset)  {
+    kPresetDefault NS_SWIFT_NAME(default) = 0,
+    kPresetFastestEncode NS_SWIFT_NAME(fastestEncode) = 1,
+    kPresetFastestDecode NS_SWIFT_NAME(fastestDecode) = 2,
+    kPresetSmallest NS_SWIFT_NAME(smallest) = 3,
+    kPresetProgressiveWeb NS_SWIFT_NAME(progressiveWeb) = 4
+};
+
+/**
+ * Advanced encoder settings, every property left at -1 keeps the encoder default
+ */
+@interface JXLEncoderOptions : NSObject
+/// Overrides effort of the encode call, 1...9
+@property (nonatomic) NSInteger effort;
+/// Overrides decoding speed of the encode call, 0...4
+@property (nonatomic) NSInteger decodingSpeed;
+/// 0 forces VarDCT, 1 forces modular
+@property (nonatomic) NSInteger modular;
+/// 0 buffers the whole frame, 1...3 trade compression for lower memory
+@property (nonatomic) NSInteger buffering;
+@property (nonatomic) NSInteger progressiveDC;
+@property (nonatomic) NSInteger progressiveAC;
+@property (nonatomic) NSInteger qProgressiveAC;
+@property (nonatomic) NSInteger responsive;
+/// 0 scanline order, 1 center first
+@property (nonatomic) NSInteger groupOrder;
+@property (nonatomic) NSInteger patches;
+@property (nonatomic) NSInteger dots;
+@property (nonatomic) NSInteger gaborish;
+/// Edge preserving filter strength, 0...3
+@property (nonatomic) NSInteger epf;
+/// 0...11
+@property (nonatomic) NSInteger brotliEffort;
+/// 5 or 10
+@property (nonatomic) NSInteger codestreamLevel;
+/// RGB ICC profile, the image is rendered into it and tagged with it instead of sRGB
+@property (nonatomic, strong, nullable) NSData *iccProfile;
+/// Raw TIFF Exif or Exif with the "Exif\0\0" signature
+@property (nonatomic, strong, nullable) NSData *exif;
+@property (nonatomic, strong, nullable) NSData *xmp;
+@property (nonatomic, strong, nullable) NSData *jumbf;
+/// Stores the metadata boxes Brotli compressed
+@property (nonatomic) BOOL compressMetadata;
+
+-(nonnull instancetype)init;
+-(nonnull instancetype)initWithPreset:(JXLEncoderPreset)preset;
+#ifdef __cplusplus
+-(jxlcoder::JxlEncoderOptions)jxlOptions;
+/// Borrows the payloads, valid while the options object is alive and unmodified
+-(jxlcoder::JxlEncoderMetadata)jxlMetadata;
+#endif
+@end
+
+#endif /* JXLEncoderOptions_h */
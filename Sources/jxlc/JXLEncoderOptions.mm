@@ -0,0 +1,113 @@
+//
+//  JXLEncoderOptions.mm
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#import <Foundation/Foundation.h>
+#import "JXLEncoderOptions.h"
+
+@implementation JXLEncoderOptions
+
+-(nonnull instancetype)init {
+    return [self initWithPreset:kPresetDefault];
+}
+
+-(nonnull instancetype)initWithPreset:(JXLEncoderPreset)preset {
+    self = [super init];
+    if (self) {
+        jxlcoder::JxlEncoderPreset jPreset = jxlcoder::JXL_ENCODER_PRESET_DEFAULT;
+        switch (preset) {
+            case kPresetDefault:
+                jPreset = jxlcoder::JXL_ENCODER_PRESET_DEFAULT;
+                break;
+            case kPresetFastestEncode:
+                jPreset = jxlcoder::JXL_ENCODER_PRESET_FASTEST_ENCODE;
+                break;
+            case kPresetFastestDecode:
+                jPreset = jxlcoder::JXL_ENCODER_PRESET_FASTEST_DECODE;
+                break;
+            case kPresetSmallest:
+                jPreset = jxlcoder::JXL_ENCODER_PRESET_SMALLEST;
+                break;
+            case kPresetProgressiveWeb:
+                jPreset = jxlcoder::JXL_ENCODER_PRESET_PROGRESSIVE_WEB;
+                break;
+        }
+        auto options = jxlcoder::JxlEncoderOptions::preset(jPreset);
+        _effort = options.effort;
+        _decodingSpeed = options.decodingSpeed;
+        _modular = options.modular;
+        _buffering = options.buffering;
+        _progressiveDC = options.progressiveDC;
+        _progressiveAC = options.progressiveAC;
+        _qProgressiveAC = options.qProgressiveAC;
+        _responsive = options.responsive;
+        _groupOrder = options.groupOrder;
+        _patches = options.patches;
+        _dots = options.dots;
+        _gaborish = options.gaborish;
+        _epf = options.epf;
+        _brotliEffort = options.brotliEffort;
+        _codestreamLevel = options.codestreamLevel;
+    }
+    return self;
+}
+
+-(jxlcoder::JxlEncoderOptions)jxlOptions {
+    jxlcoder::JxlEncoderOptions options;
+    options.effort = static_cast<int>(_effort);
+    options.decodingSpeed = static_cast<int>(_decodingSpeed);
+    options.modular = static_cast<int>(_modular);
+    options.buffering = static_cast<int>(_buffering);
+    options.progressiveDC = static_cast<int>(_progressiveDC);
+    options.progressiveAC = static_cast<int>(_progressiveAC);
+    options.qProgressiveAC = static_cast<int>(_qProgressiveAC);
+    options.responsive = static_cast<int>(_responsive);
+    options.groupOrder = static_cast<int>(_groupOrder);
+    options.patches = static_cast<int>(_patches);
+    options.dots = static_cast<int>(_dots);
+    options.gaborish = static_cast<int>(_gaborish);
+    options.epf = static_cast<int>(_epf);
+    options.brotliEffort = static_cast<int>(_brotliEffort);
+    options.codestreamLevel = static_cast<int>(_codestreamLevel);
+    return options;
+}
+
+static std::span<const uint8_t> JXLDataSpan(NSData *data) {
+    if (!data) {
+        return {};
+    }
+    return std::span<const uint8_t>(reinterpret_cast<const uint8_t*>([data bytes]), [data length]);
+}
+
+-(jxlcoder::JxlEncoderMetadata)jxlMetadata {
+    jxlcoder::JxlEncoderMetadata metadata;
+    metadata.icc = JXLDataSpan(_iccProfile);
+    metadata.exif = JXLDataSpan(_exif);
+    metadata.xmp = JXLDataSpan(_xmp);
+    metadata.jumbf = JXLDataSpan(_jumbf);
+    metadata.compressBoxes = _compressMetadata;
+    return metadata;
+}
+
+@end
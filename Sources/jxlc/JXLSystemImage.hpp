@@ -45,7 +45,8 @@
 
 typedef NS_ENUM(NSInteger, JXLColorSpace)  {
     kRGB NS_SWIFT_NAME(rgb),
-    kRGBA NS_SWIFT_NAME(rgba)
+    kRGBA NS_SWIFT_NAME(rgba),
+    kAutomatic NS_SWIFT_NAME(automatic)
 };
 
 typedef NS_ENUM(NSInteger, JXLCompressionOption) {
@@ -57,6 +58,9 @@ typedef NS_ENUM(NSInteger, JXLPreferredPixelFormat) {
     kOptimal NS_SWIFT_NAME(optimal),
     kR8 NS_SWIFT_NAME(r8),
     kFloat16 NS_SWIFT_NAME(float16),
+    /// Still images are decoded as float16 for r16 and float32
+    kR16 NS_SWIFT_NAME(r16),
+    kFloat32 NS_SWIFT_NAME(float32),
 };
 
 typedef NS_ENUM(NSInteger, JXLEncoderDecodingSpeed)  {
@@ -67,9 +71,17 @@ typedef NS_ENUM(NSInteger, JXLEncoderDecodingSpeed)  {
     kFastest NS_SWIFT_NAME(fastest) = 4
 };
 
+typedef NS_ENUM(NSInteger, JXLRateControlTarget)  {
+    kTargetSize NS_SWIFT_NAME(size),
+    kTargetPSNR NS_SWIFT_NAME(psnr)
+};
+
 @interface JXLSystemImage (JXLColorData)
 #ifdef __cplusplus
 - (bool)jxlRGBAPixels:(std::vector<uint8_t>&)buffer width:(nonnull int*)xSize height:(nonnull int*)ySize;
+/// Draws the image into the color space, device RGB when nil
+- (bool)jxlRGBAPixels:(std::vector<uint8_t>&)buffer width:(nonnull int*)xSize height:(nonnull int*)ySize
+           colorSpace:(nullable CGColorSpaceRef)targetColorSpace;
 #endif
 @end
 
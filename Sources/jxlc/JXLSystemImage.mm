@@ -58,6 +58,11 @@
 }
 
 - (bool)jxlRGBAPixels:(std::vector<uint8_t>&)buffer width:(nonnull int*)xSize height:(nonnull int*)ySize {
+    return [self jxlRGBAPixels:buffer width:xSize height:ySize colorSpace:nil];
+}
+
+- (bool)jxlRGBAPixels:(std::vector<uint8_t>&)buffer width:(nonnull int*)xSize height:(nonnull int*)ySize
+           colorSpace:(nullable CGColorSpaceRef)targetColorSpace {
     CGImageRef imageRef = [self makeCGImage];
     NSUInteger width = CGImageGetWidth(imageRef);
     NSUInteger height = CGImageGetHeight(imageRef);
@@ -66,7 +71,7 @@
     *xSize = (int)width;
     *ySize = (int)height;
 
-    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGColorSpaceRef colorSpace = targetColorSpace ? CGColorSpaceRetain(targetColorSpace) : CGColorSpaceCreateDeviceRGB();
     CGBitmapInfo bitmapInfo = (int)kCGImageAlphaPremultipliedLast | (int)kCGImageByteOrderDefault;
 
     CGContextRef targetContext = CGBitmapContextCreate(buffer.data(), width, height, 8, stride, colorSpace, bitmapInfo);
@@ -92,10 +97,15 @@
 }
 #else
 - (bool)jxlRGBAPixels:(std::vector<uint8_t>&)buffer width:(nonnull int*)xSize height:(nonnull int*)ySize {
+    return [self jxlRGBAPixels:buffer width:xSize height:ySize colorSpace:nil];
+}
+
+- (bool)jxlRGBAPixels:(std::vector<uint8_t>&)buffer width:(nonnull int*)xSize height:(nonnull int*)ySize
+           colorSpace:(nullable CGColorSpaceRef)targetColorSpace {
     CGImageRef imageRef = [self CGImage];
     NSUInteger width = CGImageGetWidth(imageRef);
     NSUInteger height = CGImageGetHeight(imageRef);
-    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGColorSpaceRef colorSpace = targetColorSpace ? CGColorSpaceRetain(targetColorSpace) : CGColorSpaceCreateDeviceRGB();
     buffer.resize(height * width * 4 * sizeof(uint8_t));
     *xSize = (int)width;
     *ySize = (int)height;
@@ -108,6 +118,9 @@
 
     CGContextDrawImage(context, CGRectMake(0, 0, width, height), imageRef);
 
+    CGContextRelease(context);
+    CGColorSpaceRelease(colorSpace);
+
     if (![self unpremultiply:buffer.data() width:width height:height]) {
         return false;
     }
@@ -24,39 +24,344 @@
 //
 
 #include "JxlAnimatedDecoder.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "concurrency.hpp"
 
-JxlFrame JxlAnimatedDecoder::getFrame(int framePosition) {
-    std::lock_guard guard(lock);
-    if (framePosition < 0) {
-        std::string str = "Frame position must be positive";
-        throw AnimatedDecoderError(str);
-    }
-
-    if (framePosition >= this->frameInfo.size()) {
-        std::string str = "Requested frame index more than frames in the container";
-        throw AnimatedDecoderError(str);
-    }
-
+void JxlAnimatedDecoder::rewindDecoder() {
     JxlDecoderRewind(dec.get());
     if (JXL_DEC_SUCCESS != JxlDecoderSubscribeEvents(dec.get(), JXL_DEC_FULL_IMAGE | JXL_DEC_FRAME)) {
         std::string str = "Cannot subscribe to events";
         throw AnimatedDecoderError(str);
     }
+    if (JXL_DEC_SUCCESS != JxlDecoderSetCoalescing(dec.get(), JXL_TRUE)) {
+        std::string str = "Cannot coalesce frames";
+        throw AnimatedDecoderError(str);
+    }
     if (JXL_DEC_SUCCESS != JxlDecoderSetInput(dec.get(), data.data(), data.size())) {
         std::string str = "Set input has failed";
         throw AnimatedDecoderError(str);
     }
     JxlDecoderCloseInput(dec.get());
-    JxlDecoderSkipFrames(dec.get(), framePosition);
-    
-    if (JXL_DEC_SUCCESS != JxlDecoderSetCoalescing(dec.get(), JXL_TRUE)) {
-        std::string str = "Cannot coalesce frames";
+    nextFramePosition = 0;
+}
+
+JxlAnimatedDecoder::~JxlAnimatedDecoder() {
+    {
+        std::lock_guard guard(scanLock);
+        scanCancelled = true;
+    }
+    if (scanThread.joinable()) {
+        scanThread.join();
+    }
+}
+
+void JxlAnimatedDecoder::startScan() {
+    scanDec = JxlDecoderMake(nullptr);
+    if (!scanDec) {
+        std::string str = "Cannot create decoder";
         throw AnimatedDecoderError(str);
     }
+    if (JXL_DEC_SUCCESS != JxlDecoderSubscribeEvents(scanDec.get(), JXL_DEC_FULL_IMAGE | JXL_DEC_FRAME)) {
+        std::string str = "Cannot subscribe to decoder events";
+        throw AnimatedDecoderError(str);
+    }
+    if (JXL_DEC_SUCCESS != JxlDecoderSetCoalescing(scanDec.get(), JXL_FALSE)) {
+        std::string str = "Cannot disable frames coalescing";
+        throw AnimatedDecoderError(str);
+    }
+    if (JXL_DEC_SUCCESS != JxlDecoderSetInput(scanDec.get(), data.data(), data.size())) {
+        std::string str = "Set input has failed";
+        throw AnimatedDecoderError(str);
+    }
+    JxlDecoderCloseInput(scanDec.get());
+}
+
+void JxlAnimatedDecoder::ensureScanned(int frame) {
+    while (!scanComplete && frame >= static_cast<int>(frameInfo.size())) {
+        scanNextFrame();
+    }
+}
+
+int JxlAnimatedDecoder::getFrameAt(uint64_t ticks) {
+    std::lock_guard guard(scanLock);
+    while (!scanComplete && scannedTicks <= ticks) {
+        if (!scanNextFrame()) {
+            break;
+        }
+    }
+    if (frameInfo.empty() || ticks >= scannedTicks) {
+        return -1;
+    }
+    auto next = std::upper_bound(frameInfo.begin(), frameInfo.end(), ticks,
+                                 [](uint64_t value, const JxlFrameInfo& frame) {
+        return value < frame.startTicks;
+    });
+    // Zero length frames share their start with the next one, the last of them is displayed
+    return static_cast<int>(std::distance(frameInfo.begin(), next)) - 1;
+}
+
+int JxlAnimatedDecoder::getFrameAtTime(double seconds) {
+    uint32_t numerator, denominator;
+    getTimebase(&numerator, &denominator);
+    if (!(seconds >= 0) || denominator == 0) {
+        return -1;
+    }
+    const double ticks = std::floor(seconds * numerator / denominator);
+    if (ticks >= static_cast<double>(std::numeric_limits<uint64_t>::max())) {
+        return -1;
+    }
+    return getFrameAt(static_cast<uint64_t>(ticks));
+}
+
+bool JxlAnimatedDecoder::scanNextFrame() {
+    // Layers are grouped into displayed frames the same way coalescing does:
+    // a layer with non-zero duration, or the last one, ends a frame
+    for (;;) {
+        JxlDecoderStatus status = JxlDecoderProcessInput(scanDec.get());
+        if (status == JXL_DEC_FRAME) {
+            JxlFrameHeader header;
+            if (JXL_DEC_SUCCESS != JxlDecoderGetFrameHeader(scanDec.get(), &header)) {
+                scanComplete = true;
+                std::string str = "Cannot retreive frame header info";
+                throw AnimatedDecoderError(str);
+            }
+            const int current = static_cast<int>(this->frameInfo.size());
+            const JxlLayerInfo &layer = header.layer_info;
+            const bool coversCanvas = !layer.have_crop ||
+                                      (layer.crop_x0 <= 0 && layer.crop_y0 <= 0 &&
+                                       layer.crop_x0 + static_cast<int64_t>(layer.xsize) >= info.xsize &&
+                                       layer.crop_y0 + static_cast<int64_t>(layer.ysize) >= info.ysize);
+            if (!coversCanvas || layer.blend_info.blendmode != JXL_BLEND_REPLACE) {
+                if (pendingLayers == 0) {
+                    pendingIndependent = false;
+                }
+                // Every frame after the one that saved the reference depends on it
+                const int writer = slotWriter[layer.blend_info.source & 3];
+                if (writer >= 0 && writer < current) {
+                    for (int i = writer + 1; i < current; ++i) {
+                        frameInfo[i].keyframe = false;
+                    }
+                    pendingIndependent = false;
+                }
+            }
+            if (!header.is_last && !(header.duration != 0 && layer.save_as_reference == 0)) {
+                slotWriter[layer.save_as_reference & 3] = current;
+            }
+            pendingLayers += 1;
+
+            if (header.duration > 0 || header.is_last) {
+                JxlAnimationHeader animation = info.animation;
+                int frameTime;
+                if (animation.tps_numerator)
+                    frameTime = (int)(1000.0 * header.duration * animation.tps_denominator / animation.tps_numerator);
+                else
+                    frameTime = 0;
+                JxlFrameInfo info = { .duration = frameTime, .ticks = header.duration,
+                                      .startTicks = scannedTicks, .timecode = header.timecode,
+                                      .layers = pendingLayers,
+                                      .keyframe = current == 0 || pendingIndependent };
+                this->frameInfo.push_back(info);
+                scannedTicks += header.duration;
+                pendingLayers = 0;
+                pendingIndependent = true;
+                return true;
+            }
+        } else if (status == JXL_DEC_NEED_IMAGE_OUT_BUFFER) {
+            if (JXL_DEC_SUCCESS != JxlDecoderSkipCurrentFrame(scanDec.get())) {
+                scanComplete = true;
+                std::string str = "Cannot properly resolve animation info";
+                throw AnimatedDecoderError(str);
+            }
+        } else if (status == JXL_DEC_FULL_IMAGE) {
+            continue;
+        } else if (status == JXL_DEC_SUCCESS) {
+            scanComplete = true;
+            scanDec.reset();
+            return false;
+        } else {
+            scanComplete = true;
+            std::string str = "Cannot retreive frame header info";
+            throw AnimatedDecoderError(str);
+        }
+    }
+}
+
+void JxlAnimatedDecoder::completeScanInBackground() {
+    std::lock_guard guard(scanLock);
+    if (scanComplete || scanThread.joinable()) {
+        return;
+    }
+    scanThread = std::thread([this] {
+        for (;;) {
+            // One frame per lock, so foreground lookups interleave with the scan
+            std::lock_guard guard(scanLock);
+            if (scanCancelled || scanComplete) {
+                return;
+            }
+            try {
+                scanNextFrame();
+            } catch (AnimatedDecoderError& err) {
+                return;
+            }
+        }
+    });
+}
+
+void JxlAnimatedDecoder::setTargetSize(uint32_t maxWidth, uint32_t maxHeight, jxlcoder::JxlResamplingFilter filter) {
+    std::lock_guard guard(lock);
+    uint32_t width = info.xsize;
+    uint32_t height = info.ysize;
+    if (maxWidth > 0 && maxHeight > 0) {
+        jxlcoder::JxlFitSize(info.xsize, info.ysize, maxWidth, maxHeight, &width, &height);
+    }
+    if ((width != info.xsize || height != info.ysize) && outputFormat.data_type != JXL_TYPE_UINT8) {
+        std::string str = "Scaled frames are supported only for 8-bit output";
+        throw AnimatedDecoderError(str);
+    }
+    if (width == info.xsize && height == info.ysize) {
+        resamplePlan.reset();
+        fullFrame.clear();
+        fullFrame.shrink_to_fit();
+    } else {
+        resamplePlan = std::make_unique<jxlcoder::JxlResamplePlan>(info.xsize, info.ysize, width, height, filter);
+    }
+    canvasFrame = -1;
+    framePool.clear();
+}
+
+void JxlAnimatedDecoder::setOutputFormat(JxlDecodingPixelFormat pixelFormat, bool rgbOnly) {
+    std::lock_guard guard(lock);
+    JxlDataType dataType;
+    switch (pixelFormat) {
+        case optimal:
+            dataType = info.bits_per_sample > 8 ? JXL_TYPE_FLOAT16 : JXL_TYPE_UINT8;
+            break;
+        case r16:
+            dataType = JXL_TYPE_UINT16;
+            break;
+        case float16:
+            dataType = JXL_TYPE_FLOAT16;
+            break;
+        case float32:
+            dataType = JXL_TYPE_FLOAT;
+            break;
+        default:
+            dataType = JXL_TYPE_UINT8;
+            break;
+    }
+    if (resamplePlan && dataType != JXL_TYPE_UINT8) {
+        std::string str = "Scaled frames are supported only for 8-bit output";
+        throw AnimatedDecoderError(str);
+    }
+    outputFormat = {static_cast<uint32_t>(rgbOnly ? 3 : 4), dataType, JXL_NATIVE_ENDIAN, 0};
+    canvasFrame = -1;
+    framePool.clear();
+}
+
+int JxlAnimatedDecoder::bytesPerSample(const JxlPixelFormat& format) {
+    switch (format.data_type) {
+        case JXL_TYPE_UINT16:
+        case JXL_TYPE_FLOAT16:
+            return 2;
+        case JXL_TYPE_FLOAT:
+            return 4;
+        default:
+            return 1;
+    }
+}
+
+size_t JxlAnimatedDecoder::frameSize() const {
+    const size_t width = resamplePlan ? resamplePlan->getDestinationWidth() : info.xsize;
+    const size_t height = resamplePlan ? resamplePlan->getDestinationHeight() : info.ysize;
+    return width * height * outputFormat.num_channels * bytesPerSample(outputFormat);
+}
+
+JxlFrame JxlAnimatedDecoder::getFrame(int framePosition) {
+    std::lock_guard guard(lock);
+    int frameTime = decodeCanvas(framePosition);
+    std::vector<uint8_t> pixels = takeBuffer();
+    pixels.assign(canvas.begin(), canvas.end());
+    JxlFrame frame = { .duration = frameTime, .pixels = std::move(pixels), .iccProfile = iccProfile };
+    return frame;
+}
+
+int JxlAnimatedDecoder::getFrame(int framePosition, std::vector<uint8_t>& pixels) {
+    std::lock_guard guard(lock);
+    if (canvasFrame == framePosition) {
+        pixels.assign(canvas.begin(), canvas.end());
+        return canvasDuration;
+    }
+    return decodeFrame(framePosition, pixels);
+}
+
+JxlFrame JxlAnimatedDecoder::nextFrame() {
+    std::lock_guard guard(lock);
+    const int framePosition = hasFrame(sequentialPosition) ? sequentialPosition : 0;
+    std::vector<uint8_t> pixels = takeBuffer();
+    int frameTime;
+    if (canvasFrame == framePosition) {
+        pixels.assign(canvas.begin(), canvas.end());
+        frameTime = canvasDuration;
+    } else {
+        frameTime = decodeFrame(framePosition, pixels);
+    }
+    sequentialPosition = framePosition + 1;
+    JxlFrame frame = { .duration = frameTime, .pixels = std::move(pixels), .iccProfile = iccProfile };
+    return frame;
+}
+
+void JxlAnimatedDecoder::recycleFrame(JxlFrame& frame) {
+    std::lock_guard guard(lock);
+    if (framePool.size() < maxPooledFrames && frame.pixels.capacity() > 0) {
+        framePool.push_back(std::move(frame.pixels));
+    }
+    frame.pixels = std::vector<uint8_t>();
+}
+
+std::vector<uint8_t> JxlAnimatedDecoder::takeBuffer() {
+    if (framePool.empty()) {
+        return std::vector<uint8_t>();
+    }
+    std::vector<uint8_t> buffer = std::move(framePool.back());
+    framePool.pop_back();
+    return buffer;
+}
+
+int JxlAnimatedDecoder::decodeCanvas(int framePosition) {
+    if (canvasFrame == framePosition) {
+        return canvasDuration;
+    }
+    canvasFrame = -1;
+    canvasDuration = decodeFrame(framePosition, canvas);
+    canvasFrame = framePosition;
+    return canvasDuration;
+}
+
+int JxlAnimatedDecoder::decodeFrame(int framePosition, std::vector<uint8_t>& pixels) {
+    if (framePosition < 0) {
+        std::string str = "Frame position must be positive";
+        throw AnimatedDecoderError(str);
+    }
+
+    if (!hasFrame(framePosition)) {
+        std::string str = "Requested frame index more than frames in the container";
+        throw AnimatedDecoderError(str);
+    }
+
+    // Decoder is left right after the last decoded frame, so playback and forward seeks
+    // just skip ahead. Backward seeks rewind and let libjxl skip frames,
+    // which after a rewind only decodes frames still needed as references
+    if (nextFramePosition < 0 || framePosition < nextFramePosition) {
+        rewindDecoder();
+    }
+    JxlDecoderSkipFrames(dec.get(), framePosition - nextFramePosition);
+    nextFramePosition = -1;
 
     int frameTime = 0;
-    std::vector<uint8_t> pixels;
-    JxlPixelFormat format = {4, JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
+    JxlPixelFormat format = outputFormat;
+    const size_t canvasSize = static_cast<size_t>(info.xsize) * info.ysize * format.num_channels * bytesPerSample(format);
     for (;;) {
         JxlDecoderStatus status = JxlDecoderProcessInput(dec.get());
         if (status == JXL_DEC_FRAME) {
@@ -72,38 +377,37 @@ JxlFrame JxlAnimatedDecoder::getFrame(int framePosition) {
                 frameTime = 0;
         } else if (status == JXL_DEC_NEED_IMAGE_OUT_BUFFER) {
             size_t bufferSize;
-            int components = 4;
             if (JXL_DEC_SUCCESS !=
                 JxlDecoderImageOutBufferSize(dec.get(), &format, &bufferSize)) {
                 std::string str = "Cannot retreive buffer info size";
                 throw AnimatedDecoderError(str);
             }
-            if (bufferSize != info.xsize * info.ysize * (components) * sizeof(uint8_t)) {
+            if (bufferSize != canvasSize) {
                 std::string str = "Cannot retreive buffer info size";
                 throw AnimatedDecoderError(str);
             }
-            pixels.resize(info.xsize * info.ysize * (components) * sizeof(uint8_t));
-            void *pixelsBuffer = (void *) pixels.data();
+            // The buffer is owned by the caller and outlives the decoding up to JXL_DEC_FULL_IMAGE,
+            // resizing a recycled buffer of the same size doesn't allocate
+            std::vector<uint8_t>& target = resamplePlan ? fullFrame : pixels;
+            target.resize(canvasSize);
+            void *pixelsBuffer = (void *) target.data();
 
             if (JXL_DEC_SUCCESS != JxlDecoderSetImageOutBuffer(dec.get(),
                                                                &format,
                                                                pixelsBuffer,
-                                                               pixels.size())) {
+                                                               target.size())) {
                 std::string str = "Cannot decoder buffer info";
                 throw AnimatedDecoderError(str);
             }
-        } else if (status == JXL_DEC_FULL_IMAGE || status == JXL_DEC_SUCCESS) {
-            // All decoding successfully finished, we are at the end of the file.
-            // We must rewind the decoder to get a new frame.
-            JxlDecoderRewind(dec.get());
-            JxlDecoderSubscribeEvents(dec.get(), JXL_DEC_FRAME | JXL_DEC_FULL_IMAGE);
-            JxlDecoderSetInput(dec.get(), data.data(), data.size());
-            JxlDecoderCloseInput(dec.get());
-
-            std::vector<uint8_t> iccCopy;
-            iccCopy = iccProfile;
-            JxlFrame frame = { .duration = frameTime, .pixels = pixels, .iccProfile = iccCopy };
-            return frame;
+        } else if (status == JXL_DEC_FULL_IMAGE) {
+            nextFramePosition = framePosition + 1;
+            if (resamplePlan) {
+                const uint32_t width = resamplePlan->getDestinationWidth();
+                const int channels = static_cast<int>(format.num_channels);
+                pixels.resize(frameSize());
+                resamplePlan->resample(fullFrame.data(), info.xsize * channels, pixels.data(), width * channels, channels);
+            }
+            return frameTime;
         } else {
             std::string str = "Error event has received";
             throw AnimatedDecoderError(str);
@@ -111,57 +415,217 @@ JxlFrame JxlAnimatedDecoder::getFrame(int framePosition) {
     }
 }
 
-JxlFrame JxlAnimatedDecoder::nextFrame() {
+void JxlAnimatedDecoder::exportFrames(int first, int count, uint8_t* const* frames, int* durations, int numThreads) {
     std::lock_guard guard(lock);
-    int frameTime = 0;
+    if (first < 0 || count <= 0) {
+        std::string str = "Frame range must be positive";
+        throw AnimatedDecoderError(str);
+    }
+    const int end = first + count;
+
+    int threads = numThreads > 0 ? numThreads : static_cast<int>(std::thread::hardware_concurrency());
+    threads = std::clamp(threads, 1, count);
+
+    // Segments start at keyframes and are at least count / threads frames long,
+    // so there is at most one segment per thread
+    std::vector<int> segmentStarts = { first };
+    {
+        std::lock_guard scanGuard(scanLock);
+        ensureScanned(end - 1);
+        if (static_cast<size_t>(end) > frameInfo.size()) {
+            std::string str = "Requested frame index more than frames in the container";
+            throw AnimatedDecoderError(str);
+        }
+        const int segmentLength = (count + threads - 1) / threads;
+        for (int i = first + 1; i < end; ++i) {
+            if (frameInfo[i].keyframe && i - segmentStarts.back() >= segmentLength) {
+                segmentStarts.push_back(i);
+            }
+        }
+        if (durations) {
+            for (int i = first; i < end; ++i) {
+                durations[i - first] = frameInfo[i].duration;
+            }
+        }
+    }
+    segmentStarts.push_back(end);
+
+    const int segments = static_cast<int>(segmentStarts.size()) - 1;
+    const int segmentThreads = std::max(threads / segments, 1);
+    std::vector<std::string> errors(segments);
+    concurrency::parallel_for(segments, segments, [&](int segment) {
+        try {
+            const int start = segmentStarts[segment];
+            decodeSegment(start, segmentStarts[segment + 1], frames + (start - first), segmentThreads);
+        } catch (AnimatedDecoderError& err) {
+            errors[segment] = err.what();
+        } catch (std::bad_alloc& err) {
+            errors[segment] = err.what();
+        }
+    });
+
+    for (const std::string& error : errors) {
+        if (!error.empty()) {
+            throw AnimatedDecoderError(error);
+        }
+    }
+}
+
+void JxlAnimatedDecoder::decodeSegment(int start, int end, uint8_t* const* frames, int numThreads) const {
+    JxlDecoderPtr segmentDec = JxlDecoderMake(nullptr);
+    if (!segmentDec) {
+        std::string str = "Cannot create decoder";
+        throw AnimatedDecoderError(str);
+    }
+    JxlResizableParallelRunnerPtr segmentRunner = JxlResizableParallelRunnerMake(nullptr);
+    JxlResizableParallelRunnerSetThreads(segmentRunner.get(), numThreads);
+    if (JXL_DEC_SUCCESS != JxlDecoderSetParallelRunner(segmentDec.get(),
+                                                       JxlResizableParallelRunner,
+                                                       segmentRunner.get())) {
+        std::string str = "Cannot attach parallel runner to decoder";
+        throw AnimatedDecoderError(str);
+    }
+    if (JXL_DEC_SUCCESS != JxlDecoderSetUnpremultiplyAlpha(segmentDec.get(), JXL_TRUE)) {
+        std::string str = "Cannot initialize decoder";
+        throw AnimatedDecoderError(str);
+    }
+    if (JXL_DEC_SUCCESS != JxlDecoderSubscribeEvents(segmentDec.get(), JXL_DEC_FULL_IMAGE)) {
+        std::string str = "Cannot subscribe to events";
+        throw AnimatedDecoderError(str);
+    }
+    if (JXL_DEC_SUCCESS != JxlDecoderSetInput(segmentDec.get(), data.data(), data.size())) {
+        std::string str = "Set input has failed";
+        throw AnimatedDecoderError(str);
+    }
+    JxlDecoderCloseInput(segmentDec.get());
+    JxlDecoderSkipFrames(segmentDec.get(), start);
+
+    JxlPixelFormat format = outputFormat;
+    const int channels = static_cast<int>(format.num_channels);
+    const size_t canvasSize = static_cast<size_t>(info.xsize) * info.ysize * channels * bytesPerSample(format);
+    std::vector<uint8_t> scaleBuffer;
+    int frame = start;
+    while (frame < end) {
+        JxlDecoderStatus status = JxlDecoderProcessInput(segmentDec.get());
+        if (status == JXL_DEC_NEED_IMAGE_OUT_BUFFER) {
+            size_t bufferSize;
+            if (JXL_DEC_SUCCESS != JxlDecoderImageOutBufferSize(segmentDec.get(), &format, &bufferSize) ||
+                bufferSize != canvasSize) {
+                std::string str = "Cannot retreive buffer info size";
+                throw AnimatedDecoderError(str);
+            }
+            uint8_t* target = frames[frame - start];
+            if (resamplePlan) {
+                scaleBuffer.resize(canvasSize);
+                target = scaleBuffer.data();
+            }
+            if (JXL_DEC_SUCCESS != JxlDecoderSetImageOutBuffer(segmentDec.get(), &format, target, canvasSize)) {
+                std::string str = "Cannot decoder buffer info";
+                throw AnimatedDecoderError(str);
+            }
+        } else if (status == JXL_DEC_FULL_IMAGE) {
+            if (resamplePlan) {
+                resamplePlan->resample(scaleBuffer.data(), info.xsize * channels, frames[frame - start],
+                                       resamplePlan->getDestinationWidth() * channels, channels, numThreads);
+            }
+            frame += 1;
+        } else {
+            std::string str = "Error event has received";
+            throw AnimatedDecoderError(str);
+        }
+    }
+}
+
+void JxlAnimatedDecoder::rewindLayers() {
+    if (!layerDec) {
+        layerDec = JxlDecoderMake(nullptr);
+        if (!layerDec) {
+            std::string str = "Cannot create decoder";
+            throw AnimatedDecoderError(str);
+        }
+        if (JXL_DEC_SUCCESS != JxlDecoderSetUnpremultiplyAlpha(layerDec.get(), JXL_TRUE)) {
+            std::string str = "Cannot initialize decoder";
+            throw AnimatedDecoderError(str);
+        }
+        // Layers are decoded under the same lock as frames, so the runner is never used concurrently
+        if (JXL_DEC_SUCCESS != JxlDecoderSetParallelRunner(layerDec.get(),
+                                                           JxlResizableParallelRunner,
+                                                           runner.get())) {
+            std::string str = "Cannot attach parallel runner to decoder";
+            throw AnimatedDecoderError(str);
+        }
+    } else {
+        JxlDecoderRewind(layerDec.get());
+    }
+    if (JXL_DEC_SUCCESS != JxlDecoderSubscribeEvents(layerDec.get(), JXL_DEC_FULL_IMAGE | JXL_DEC_FRAME)) {
+        std::string str = "Cannot subscribe to events";
+        throw AnimatedDecoderError(str);
+    }
+    if (JXL_DEC_SUCCESS != JxlDecoderSetCoalescing(layerDec.get(), JXL_FALSE)) {
+        std::string str = "Cannot disable frames coalescing";
+        throw AnimatedDecoderError(str);
+    }
+    if (JXL_DEC_SUCCESS != JxlDecoderSetInput(layerDec.get(), data.data(), data.size())) {
+        std::string str = "Set input has failed";
+        throw AnimatedDecoderError(str);
+    }
+    JxlDecoderCloseInput(layerDec.get());
+}
+
+bool JxlAnimatedDecoder::nextLayer(JxlLayer& layer) {
+    std::lock_guard guard(lock);
+    if (!layerDec) {
+        rewindLayers();
+    }
+
+    JxlPixelFormat format = {4, JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
     for (;;) {
-        JxlDecoderStatus status = JxlDecoderProcessInput(dec.get());
-        if (status == JXL_DEC_FULL_IMAGE || status == JXL_DEC_SUCCESS) {
-            // All decoding successfully finished, we are at the end of the file.
-            // We must rewind the decoder to get a new frame.
-            JxlDecoderRewind(dec.get());
-            JxlDecoderSubscribeEvents(dec.get(), JXL_DEC_FRAME | JXL_DEC_FULL_IMAGE);
-            JxlDecoderSetInput(dec.get(), data.data(), data.size());
-            JxlDecoderCloseInput(dec.get());
-        } else if (status == JXL_DEC_FRAME) {
+        JxlDecoderStatus status = JxlDecoderProcessInput(layerDec.get());
+        if (status == JXL_DEC_FRAME) {
             JxlFrameHeader header;
-            if (JXL_DEC_SUCCESS != JxlDecoderGetFrameHeader(dec.get(), &header)) {
+            if (JXL_DEC_SUCCESS != JxlDecoderGetFrameHeader(layerDec.get(), &header)) {
                 std::string str = "Cannot retreive frame header info";
                 throw AnimatedDecoderError(str);
             }
+            const JxlLayerInfo &layerInfo = header.layer_info;
+            layer.x = layerInfo.crop_x0;
+            layer.y = layerInfo.crop_y0;
+            layer.width = layerInfo.xsize;
+            layer.height = layerInfo.ysize;
+            layer.blendMode = layerInfo.blend_info.blendmode;
+            layer.source = static_cast<int>(layerInfo.blend_info.source);
+            const bool referenced = !header.is_last && !(header.duration != 0 && layerInfo.save_as_reference == 0);
+            layer.saveAsReference = referenced ? static_cast<int>(layerInfo.save_as_reference) : -1;
+            layer.endsFrame = header.duration > 0 || header.is_last;
             JxlAnimationHeader animation = info.animation;
             if (animation.tps_numerator)
-                frameTime = (int)(1000.0 * header.duration * animation.tps_denominator / animation.tps_numerator);
+                layer.duration = (int)(1000.0 * header.duration * animation.tps_denominator / animation.tps_numerator);
             else
-                frameTime = 0;
+                layer.duration = 0;
         } else if (status == JXL_DEC_NEED_IMAGE_OUT_BUFFER) {
             size_t bufferSize;
-            JxlPixelFormat format = {4, JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
-            int components = 4;
             if (JXL_DEC_SUCCESS !=
-                JxlDecoderImageOutBufferSize(dec.get(), &format, &bufferSize)) {
+                JxlDecoderImageOutBufferSize(layerDec.get(), &format, &bufferSize)) {
                 std::string str = "Cannot retreive buffer info size";
                 throw AnimatedDecoderError(str);
             }
-            if (bufferSize != info.xsize * info.ysize * (components) * sizeof(uint8_t)) {
+            if (bufferSize != static_cast<size_t>(layer.width) * layer.height * 4 * sizeof(uint8_t)) {
                 std::string str = "Cannot retreive buffer info size";
                 throw AnimatedDecoderError(str);
             }
-            std::vector<uint8_t> pixels;
-            pixels.resize(info.xsize * info.ysize * (components) * sizeof(uint8_t));
-            void *pixelsBuffer = (void *) pixels.data();
-
-            if (JXL_DEC_SUCCESS != JxlDecoderSetImageOutBuffer(dec.get(),
+            layer.pixels.resize(bufferSize);
+            if (JXL_DEC_SUCCESS != JxlDecoderSetImageOutBuffer(layerDec.get(),
                                                                &format,
-                                                               pixelsBuffer,
-                                                               pixels.size())) {
+                                                               layer.pixels.data(),
+                                                               layer.pixels.size())) {
                 std::string str = "Cannot decoder buffer info";
                 throw AnimatedDecoderError(str);
             }
-            std::vector<uint8_t> iccCopy;
-            iccCopy = iccProfile;
-            JxlFrame frame = { .duration = frameTime, .pixels = pixels, .iccProfile = iccCopy };
-            return frame;
+        } else if (status == JXL_DEC_FULL_IMAGE) {
+            return true;
+        } else if (status == JXL_DEC_SUCCESS) {
+            rewindLayers();
+            return false;
         } else {
             std::string str = "Error event has received";
             throw AnimatedDecoderError(str);
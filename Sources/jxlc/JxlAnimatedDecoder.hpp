@@ -36,6 +36,12 @@
 #include <jxl/resizable_parallel_runner.h>
 #include <jxl/resizable_parallel_runner_cxx.h>
 #include <thread>
+#include <mutex>
+#include <memory>
+#include <climits>
+#include "JxlResampler.hpp"
+#include "JxlDefinitions.h"
+#include <utility>
 
 class AnimatedDecoderError : public std::exception {
 public:
@@ -51,12 +57,46 @@ private:
 
 struct JxlFrame {
     std::vector<uint8_t> pixels;
-    std::vector<uint8_t> iccProfile;
+    /// Shared by all frames of the decoder
+    std::shared_ptr<const std::vector<uint8_t>> iccProfile;
     int duration;
 };
 
+/**
+ * Non-coalesced layer as it is stored in the codestream, before blending onto the canvas
+ */
+struct JxlLayer {
+    /// RGBA8 unpremultiplied pixels of the crop rectangle
+    std::vector<uint8_t> pixels;
+    /// Crop origin on the canvas, may be negative
+    int x = 0;
+    int y = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    JxlBlendMode blendMode = JXL_BLEND_REPLACE;
+    /// Reference slot the layer is blended onto
+    int source = 0;
+    /// Reference slot the blended canvas is saved into, -1 when it isn't referenced later
+    int saveAsReference = -1;
+    /// Display duration in milliseconds, 0 for layers composited into the next one
+    int duration = 0;
+    /// Layer completes a displayed frame
+    bool endsFrame = false;
+};
+
 struct JxlFrameInfo {
+    // Duration in milliseconds, truncated
     int duration;
+    // Exact duration in ticks of the animation timebase
+    uint32_t ticks;
+    // Sum of ticks of every preceding frame
+    uint64_t startTicks;
+    // SMPTE timecode of the frame when the animation stores them, otherwise 0
+    uint32_t timecode;
+    // Number of non-coalesced layers composited into this frame
+    int layers;
+    // Frame canvas doesn't depend on any previously displayed frame
+    bool keyframe;
 };
 
 class JxlAnimatedDecoder {
@@ -84,9 +124,7 @@ public:
         
         if (JXL_DEC_SUCCESS !=
             JxlDecoderSubscribeEvents(dec.get(), JXL_DEC_BASIC_INFO |
-                                                 JXL_DEC_COLOR_ENCODING |
-                                                 JXL_DEC_FULL_IMAGE |
-                                                 JXL_DEC_FRAME)) {
+                                                 JXL_DEC_COLOR_ENCODING)) {
             std::string str = "Cannot subscribe to decoder events";
             throw AnimatedDecoderError(str);
         }
@@ -98,20 +136,13 @@ public:
             throw AnimatedDecoderError(str);
         }
 
-        if (JXL_DEC_SUCCESS != JxlDecoderSetCoalescing(dec.get(), JXL_FALSE)) {
-            std::string str = "Cannot coalesce frames";
-            throw AnimatedDecoderError(str);
-        }
-
         JxlDecoderSetInput(dec.get(), data.data(), data.size());
         JxlDecoderCloseInput(dec.get());
 
+        // Only the image header is read here, frame headers are scanned as frames are reached
         for (;;) {
             JxlDecoderStatus status = JxlDecoderProcessInput(dec.get());
-            if (status == JXL_DEC_ERROR) {
-                std::string str = "Cannot retreive basic info";
-                throw AnimatedDecoderError(str);
-            } else if (status == JXL_DEC_BASIC_INFO) {
+            if (status == JXL_DEC_BASIC_INFO) {
                 if (JXL_DEC_SUCCESS != JxlDecoderGetBasicInfo(dec.get(), &info)) {
                     std::string str = "Cannot retreive basic info";
                     throw AnimatedDecoderError(str);
@@ -123,59 +154,65 @@ public:
                 JxlResizableParallelRunnerSetThreads(
                         runner.get(),
                         JxlResizableParallelRunnerSuggestThreads(info.xsize, info.ysize));
-            } else if (status == JXL_DEC_FULL_IMAGE) {
-                // All decoding successfully finished, we are at the end of the file.
-                // We must rewind the decoder to get a new frame.
-                JxlDecoderRewind(dec.get());
-                JxlDecoderSubscribeEvents(dec.get(), JXL_DEC_FRAME | JXL_DEC_FULL_IMAGE);
-                JxlDecoderSetInput(dec.get(), data.data(), data.size());
-                JxlDecoderCloseInput(dec.get());
-                break;
-            } else if (status == JXL_DEC_FRAME) {
-                JxlFrameHeader header;
-                if (JXL_DEC_SUCCESS != JxlDecoderGetFrameHeader(dec.get(), &header)) {
-                    std::string str = "Cannot retreive frame header info";
-                    throw AnimatedDecoderError(str);
-                }
-                JxlAnimationHeader animation = info.animation;
-                int frameTime;
-                if (animation.tps_numerator)
-                    frameTime = (int)(1000.0 * header.duration * animation.tps_denominator / animation.tps_numerator);
-                else
-                    frameTime = 0;
-                JxlFrameInfo info = { .duration = frameTime };
-                this->frameInfo.push_back(info);
-            } else if (status == JXL_DEC_NEED_IMAGE_OUT_BUFFER) {
-                if (JXL_DEC_SUCCESS != JxlDecoderSkipCurrentFrame(dec.get())) {
-                    std::string str = "Cannot properly resolve animation info";
-                    throw AnimatedDecoderError(str);
-                }
             } else if (status == JXL_DEC_COLOR_ENCODING) {
                 size_t iccSize;
                 if (JXL_DEC_SUCCESS ==
                     JxlDecoderGetICCProfileSize(dec.get(), JXL_COLOR_PROFILE_TARGET_DATA, &iccSize)) {
-                    iccProfile.resize(iccSize);
+                    iccProfile->resize(iccSize);
                     if (JXL_DEC_SUCCESS != JxlDecoderGetColorAsICCProfile(dec.get(), JXL_COLOR_PROFILE_TARGET_DATA,
-                                                                          iccProfile.data(), iccProfile.size())) {
+                                                                          iccProfile->data(), iccProfile->size())) {
                         std::string str = "Cannot retreive color icc profile";
                         throw AnimatedDecoderError(str);
                     }
                 } else {
-                    iccProfile.resize(0);
+                    iccProfile->resize(0);
                 }
-                iccProfile.resize(iccSize);
-            } else if (status == JXL_DEC_SUCCESS) {
-                JxlDecoderRewind(dec.get());
-                JxlDecoderSubscribeEvents(dec.get(), JXL_DEC_FRAME | JXL_DEC_FULL_IMAGE);
-                JxlDecoderSetInput(dec.get(), data.data(), data.size());
-                JxlDecoderCloseInput(dec.get());
                 break;
+            } else {
+                std::string str = "Cannot retreive basic info";
+                throw AnimatedDecoderError(str);
             }
         }
+
+        rewindDecoder();
+        startScan();
     }
 
+    ~JxlAnimatedDecoder();
+
+    /**
+     * Frames in display order, wrapping to the first one after the last.
+     * Pixels of returned frames come from a pool, pass frames back with recycleFrame
+     * and steady-state decoding doesn't allocate
+     */
     JxlFrame nextFrame();
     JxlFrame getFrame(int at);
+    /**
+     * Returns frame pixels to the pool for the following frames
+     */
+    void recycleFrame(JxlFrame& frame);
+    /**
+     * Decodes the frame into a caller owned buffer, reusing its capacity
+     * @return frame duration in milliseconds
+     */
+    int getFrame(int at, std::vector<uint8_t>& pixels);
+
+    /**
+     * Bulk export of frames [first, first + count). The range is split at keyframes and the segments
+     * are decoded concurrently, each by its own decoder over the shared input.
+     * @param frames destination of every frame in order, getFrameSize() bytes each
+     * @param durations optional durations in milliseconds, count entries
+     * @param numThreads 0 means one per core
+     */
+    void exportFrames(int first, int count, uint8_t* const* frames, int* durations = nullptr, int numThreads = 0);
+
+    /**
+     * Decodes the next layer without coalescing, on a decoder separate from frame access.
+     * Layers come with their crop rectangle and blending info, JxlLayerCompositor applies them
+     * @return false after the last layer, the next call starts over from the first one
+     */
+    bool nextLayer(JxlLayer& layer);
+    void rewindLayers();
 
     int getLoopCount() {
         return loopCount;
@@ -189,15 +226,153 @@ public:
         return info.ysize;
     }
 
+    /**
+     * Frames are produced already scaled to fit into the size, the aspect ratio is kept and frames
+     * are never upscaled. One resampling plan is shared by all frames.
+     * Zero size restores the full canvas size
+     */
+    void setTargetSize(uint32_t maxWidth, uint32_t maxHeight,
+                       jxlcoder::JxlResamplingFilter filter = jxlcoder::JXL_RESAMPLING_LANCZOS3);
+
+    /**
+     * Sample type of frames returned by getFrame and nextFrame, RGBA8 by default.
+     * optimal picks float16 for images deeper than 8 bits, rgbOnly drops the alpha channel.
+     * Scaled frames are available only for 8-bit samples
+     */
+    void setOutputFormat(JxlDecodingPixelFormat pixelFormat, bool rgbOnly = false);
+
+    int getComponents() {
+        std::lock_guard guard(lock);
+        return static_cast<int>(outputFormat.num_channels);
+    }
+
+    int getBytesPerSample() {
+        std::lock_guard guard(lock);
+        return bytesPerSample(outputFormat);
+    }
+
+    bool isFloatOutput() {
+        std::lock_guard guard(lock);
+        return outputFormat.data_type == JXL_TYPE_FLOAT16 || outputFormat.data_type == JXL_TYPE_FLOAT;
+    }
+
+    /**
+     * Bytes of one frame returned by getFrame and nextFrame
+     */
+    size_t getFrameSize() {
+        std::lock_guard guard(lock);
+        return frameSize();
+    }
+
+    /**
+     * Size of frames returned by getFrame and nextFrame
+     */
+    int getFrameWidth() {
+        std::lock_guard guard(lock);
+        return resamplePlan ? static_cast<int>(resamplePlan->getDestinationWidth()) : static_cast<int>(info.xsize);
+    }
+
+    int getFrameHeight() {
+        std::lock_guard guard(lock);
+        return resamplePlan ? static_cast<int>(resamplePlan->getDestinationHeight()) : static_cast<int>(info.ysize);
+    }
+
+    const std::vector<uint8_t>& getIccProfile() {
+        return *iccProfile;
+    }
+
+    /**
+     * Scans headers of all frames when they weren't reached yet
+     */
     int getNumberOfFrames() {
+        std::lock_guard guard(scanLock);
+        ensureScanned(INT_MAX);
         return static_cast<int>(frameInfo.size());
     }
 
+    /**
+     * Total duration of all frames in milliseconds, scans all frame headers
+     */
+    int getTotalDuration() {
+        std::lock_guard guard(scanLock);
+        ensureScanned(INT_MAX);
+        int duration = 0;
+        for (const JxlFrameInfo& frame : frameInfo) {
+            duration += frame.duration;
+        }
+        return duration;
+    }
+
+    /**
+     * Whether the frame exists, scanning headers only up to it
+     */
+    bool hasFrame(int frame) {
+        std::lock_guard guard(scanLock);
+        if (frame < 0) {
+            return false;
+        }
+        ensureScanned(frame);
+        return static_cast<size_t>(frame) < this->frameInfo.size();
+    }
+
+    /**
+     * Ticks per second of frame durations are numerator / denominator
+     */
+    void getTimebase(uint32_t* numerator, uint32_t* denominator) {
+        *numerator = info.have_animation ? info.animation.tps_numerator : 1;
+        *denominator = info.have_animation ? info.animation.tps_denominator : 1;
+    }
+
+    bool hasTimecodes() {
+        return info.have_animation && info.animation.have_timecodes;
+    }
+
+    /**
+     * Exact frame duration in ticks of the timebase
+     */
+    uint32_t getFrameTicks(int frame) {
+        std::lock_guard guard(scanLock);
+        if (frame < 0) {
+            return 0;
+        }
+        ensureScanned(frame);
+        if (static_cast<size_t>(frame) >= this->frameInfo.size()) {
+            return 0;
+        }
+        return frameInfo[frame].ticks;
+    }
+
+    uint32_t getFrameTimecode(int frame) {
+        std::lock_guard guard(scanLock);
+        if (frame < 0) {
+            return 0;
+        }
+        ensureScanned(frame);
+        if (static_cast<size_t>(frame) >= this->frameInfo.size()) {
+            return 0;
+        }
+        return frameInfo[frame].timecode;
+    }
+
+    /**
+     * Frame displayed at the timestamp, found by binary search over cumulative durations.
+     * Headers are scanned only up to the timestamp
+     * @return -1 when the timestamp is past the end of the animation
+     */
+    int getFrameAt(uint64_t ticks);
+
+    /**
+     * @param seconds timestamp from the start of the animation, converted to ticks of the timebase
+     * @return -1 when the timestamp is out of the animation
+     */
+    int getFrameAtTime(double seconds);
+
     int getFrameDuration(int frame) {
-        std::lock_guard guard(lock);
+        std::lock_guard guard(scanLock);
         if (frame < 0) {
             return 0;
         }
+        ensureScanned(frame);
 
         if (frame >= this->frameInfo.size()) {
             return 0;
@@ -206,17 +381,103 @@ public:
         return info.duration;
     }
 
+    /**
+     * Frame whose canvas doesn't depend on previously displayed frames.
+     * Computed from layer headers, so it's a hint for splitting and prefetching work:
+     * decoding itself always lets libjxl resolve references.
+     * Final once the headers of all frames are scanned, a later frame may still refer past it
+     */
+    bool isKeyframe(int frame) {
+        std::lock_guard guard(scanLock);
+        if (frame < 0) {
+            return false;
+        }
+        ensureScanned(frame);
+        if (static_cast<size_t>(frame) >= this->frameInfo.size()) {
+            return false;
+        }
+        return frameInfo[frame].keyframe;
+    }
+
+    /**
+     * Nearest keyframe at or before the frame, 0 when frame is out of range
+     */
+    int getKeyframe(int frame) {
+        std::lock_guard guard(scanLock);
+        if (frame < 0) {
+            return 0;
+        }
+        ensureScanned(frame);
+        if (static_cast<size_t>(frame) >= this->frameInfo.size()) {
+            return 0;
+        }
+        while (frame > 0 && !frameInfo[frame].keyframe) {
+            frame -= 1;
+        }
+        return frame;
+    }
+
+    /**
+     * Completes the header scan on a background thread, so frame count and total duration
+     * become available without blocking on them
+     */
+    void completeScanInBackground();
+
+    bool isScanComplete() {
+        std::lock_guard guard(scanLock);
+        return scanComplete;
+    }
+
 private:
+    void rewindDecoder();
+    int decodeCanvas(int framePosition);
+    int decodeFrame(int framePosition, std::vector<uint8_t>& pixels);
+    std::vector<uint8_t> takeBuffer();
+    size_t frameSize() const;
+    void decodeSegment(int start, int end, uint8_t* const* frames, int numThreads) const;
+    static int bytesPerSample(const JxlPixelFormat& format);
+    void startScan();
+    // Both require scanLock to be held
+    void ensureScanned(int frame);
+    bool scanNextFrame();
+
     std::vector<uint8_t> data;
-    std::vector<uint8_t> iccProfile;
+    std::shared_ptr<std::vector<uint8_t>> iccProfile = std::make_shared<std::vector<uint8_t>>();
     std::vector<JxlFrameInfo> frameInfo;
+    uint64_t scannedTicks = 0;
     JxlDecoderPtr dec;
+    JxlDecoderPtr layerDec;
     JxlBasicInfo info;
     int loopCount;
     int denom;
     int numer;
     JxlResizableParallelRunnerPtr runner;
     std::mutex lock;
+    // Header scan runs on its own decoder, frameInfo only grows and is guarded by scanLock
+    std::mutex scanLock;
+    JxlDecoderPtr scanDec;
+    bool scanComplete = false;
+    bool scanCancelled = false;
+    int pendingLayers = 0;
+    bool pendingIndependent = true;
+    // Frame that last saved each reference slot
+    int slotWriter[4] = {-1, -1, -1, -1};
+    std::thread scanThread;
+    // Frame the coalescing decoder emits next without a rewind, -1 when unknown
+    int nextFramePosition = -1;
+    // Last composited canvas, reused as the decode target
+    std::vector<uint8_t> canvas;
+    int canvasFrame = -1;
+    int canvasDuration = 0;
+    // Frame returned by the next nextFrame call
+    int sequentialPosition = 0;
+    std::vector<std::vector<uint8_t>> framePool;
+    // Sample layout frames are decoded into
+    JxlPixelFormat outputFormat = {4, JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
+    std::unique_ptr<jxlcoder::JxlResamplePlan> resamplePlan;
+    // Full canvas decode target when frames are scaled
+    std::vector<uint8_t> fullFrame;
+    static constexpr size_t maxPooledFrames = 4;
 };
 
 #endif
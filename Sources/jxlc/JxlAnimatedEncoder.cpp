@@ -24,42 +24,373 @@
 //
 
 #include "JxlAnimatedEncoder.hpp"
+#include "JxlFrameDiff.hpp"
+#include <algorithm>
+#include <limits>
 
-void JxlAnimatedEncoder::addFrame(std::vector<uint8_t>& data, int frameTime) {
+void JxlAnimatedEncoder::addFrame(std::vector<uint8_t>& data, int frameTime,
+                                  const JxlAnimatedFrameOptions& frameOptions) {
+    if (asyncStarted) {
+        std::vector<uint8_t> copy(data);
+        addFrame(std::move(copy), frameTime, frameOptions);
+        return;
+    }
+    encodeFrame(data, frameTime, frameOptions);
+}
+
+void JxlAnimatedEncoder::addFrame(std::vector<uint8_t>&& data, int frameTime,
+                                  const JxlAnimatedFrameOptions& frameOptions) {
+    if (!asyncStarted) {
+        encodeFrame(data, frameTime, frameOptions);
+        return;
+    }
+    std::unique_lock queueGuard(queueLock);
+    queueChanged.wait(queueGuard, [this] {
+        return queue.size() < queueCapacity || asyncError;
+    });
+    if (asyncError) {
+        std::rethrow_exception(asyncError);
+    }
+    queue.push_back({std::move(data), frameTime, frameOptions});
+    queueChanged.notify_all();
+}
+
+void JxlAnimatedEncoder::addYuvFrame(const jxlcoder::JxlYuvFrame& frame, int frameTime,
+                                     const JxlAnimatedFrameOptions& frameOptions, int numThreads) {
+    if (pixelType != rgb && pixelType != rgba) {
+        std::string str = "YUV frames require RGB or RGBA animation";
+        throw AnimatedEncoderError(str);
+    }
+    if (encodingPixelFormat != er8 && encodingPixelFormat != er16) {
+        std::string str = "YUV frames require 8 or 16 bit animation";
+        throw AnimatedEncoderError(str);
+    }
+    // Converted samples keep the transfer of the video, they are never linear
+    if (transfer == etLinear) {
+        std::string str = "YUV frames require an animation with a non-linear transfer function";
+        throw AnimatedEncoderError(str);
+    }
+    if (numThreads <= 0) {
+        numThreads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+    }
+    std::vector<uint8_t> pixels(getFrameSize());
+    if (!jxlcoder::JxlConvertYuvToRgb(frame, width, height, pixels.data(),
+                                      pixelFormat.num_channels, encodingPixelFormat == er16, numThreads)) {
+        std::string str = "Invalid YUV frame";
+        throw AnimatedEncoderError(str);
+    }
+    addFrame(std::move(pixels), frameTime, frameOptions);
+}
+
+void JxlAnimatedEncoder::startAsync(size_t capacity) {
+    std::lock_guard queueGuard(queueLock);
+    if (asyncStarted) {
+        return;
+    }
+    queueCapacity = std::max(capacity, static_cast<size_t>(1));
+    queueClosed = false;
+    asyncStarted = true;
+    worker = std::thread(&JxlAnimatedEncoder::asyncWorker, this);
+}
+
+void JxlAnimatedEncoder::asyncWorker() {
+    while (true) {
+        QueuedFrame frame;
+        {
+            std::unique_lock queueGuard(queueLock);
+            queueChanged.wait(queueGuard, [this] { return !queue.empty() || queueClosed; });
+            if (queue.empty()) {
+                return;
+            }
+            frame = std::move(queue.front());
+            queue.pop_front();
+            queueChanged.notify_all();
+        }
+        try {
+            encodeFrame(frame.data, frame.frameTime, frame.frameOptions);
+        } catch (...) {
+            std::lock_guard queueGuard(queueLock);
+            asyncError = std::current_exception();
+            queue.clear();
+            queueChanged.notify_all();
+            return;
+        }
+    }
+}
+
+void JxlAnimatedEncoder::stopAsync(bool discardQueued) {
+    {
+        std::lock_guard queueGuard(queueLock);
+        if (!asyncStarted) {
+            return;
+        }
+        if (discardQueued) {
+            queue.clear();
+        }
+        queueClosed = true;
+        queueChanged.notify_all();
+    }
+    if (worker.joinable()) {
+        worker.join();
+    }
+    asyncStarted = false;
+}
+
+void JxlAnimatedEncoder::setOutputSink(JxlEncoderOutputSink sink) {
+    std::lock_guard guard(lock);
+    if (addedFrames > 0) {
+        std::string str = "Output sink must be set before the first frame";
+        throw AnimatedEncoderError(str);
+    }
+    JxlEncoderOutputProcessor processor = {
+        .opaque = this,
+        .get_buffer = &JxlAnimatedEncoder::getOutputBuffer,
+        .release_buffer = &JxlAnimatedEncoder::releaseOutputBuffer,
+        .seek = nullptr,
+        .set_finalized_position = &JxlAnimatedEncoder::setFinalizedPosition,
+    };
+    if (JXL_ENC_SUCCESS != JxlEncoderSetOutputProcessor(enc.get(), processor)) {
+        std::string str = "Cannot set output processor";
+        throw AnimatedEncoderError(str);
+    }
+    outputSink = std::move(sink);
+    outputChunk.resize(1024 * 64);
+}
+
+void* JxlAnimatedEncoder::getOutputBuffer(void* opaque, size_t* size) {
+    auto encoder = reinterpret_cast<JxlAnimatedEncoder*>(opaque);
+    if (encoder->outputFailed) {
+        *size = 0;
+        return nullptr;
+    }
+    if (*size > encoder->outputChunk.size()) {
+        *size = encoder->outputChunk.size();
+    }
+    return encoder->outputChunk.data();
+}
+
+void JxlAnimatedEncoder::releaseOutputBuffer(void* opaque, size_t writtenBytes) {
+    auto encoder = reinterpret_cast<JxlAnimatedEncoder*>(opaque);
+    if (writtenBytes > 0 && !encoder->outputFailed) {
+        encoder->outputFailed = !encoder->outputSink(encoder->outputChunk.data(), writtenBytes);
+    }
+}
+
+void JxlAnimatedEncoder::setFinalizedPosition(void*, uint64_t) {
+    // Without seek support every released byte is already final
+}
+
+void JxlAnimatedEncoder::flushOutput() {
+    if (!outputSink) {
+        return;
+    }
+    if (JXL_ENC_SUCCESS != JxlEncoderFlushInput(enc.get()) || outputFailed) {
+        std::string str = "Writing encoded output has failed";
+        throw AnimatedEncoderError(str);
+    }
+}
+
+JxlEncoderFrameSettings* JxlAnimatedEncoder::getFrameSettings(const JxlAnimatedFrameOptions& frameOptions) {
+    if (!frameOptions.hasSettingsOverrides()) {
+        return frameSettings;
+    }
+    const auto key = std::make_tuple(frameOptions.distance, frameOptions.effort, frameOptions.lossless);
+    auto cached = frameSettingsCache.find(key);
+    if (cached != frameSettingsCache.end()) {
+        return cached->second;
+    }
+
+    if (frameOptions.lossless == 1 && !basicInfo.uses_original_profile) {
+        std::string str = "Lossless frames require a lossless animation";
+        throw AnimatedEncoderError(str);
+    }
+
+    // Starts from a copy of the animation settings so bit depth and advanced options carry over
+    JxlEncoderFrameSettings* settings = JxlEncoderFrameSettingsCreate(enc.get(), frameSettings);
+    if (!settings) {
+        std::string str = "Cannot create frame settings";
+        throw AnimatedEncoderError(str);
+    }
+
+    if (frameOptions.lossless >= 0) {
+        if (JXL_ENC_SUCCESS != JxlEncoderSetFrameLossless(settings, frameOptions.lossless == 1)) {
+            std::string str = "Set frame to loseless has failed";
+            throw AnimatedEncoderError(str);
+        }
+    }
+
+    if (frameOptions.distance >= 0 && frameOptions.lossless != 1) {
+        if (JXL_ENC_SUCCESS != JxlEncoderSetFrameDistance(settings, frameOptions.distance)) {
+            std::string str = "Set frame distance has failed";
+            throw AnimatedEncoderError(str);
+        }
+        if (basicInfo.num_extra_channels > 0) {
+            if (JXL_ENC_SUCCESS != JxlEncoderSetExtraChannelDistance(settings, 0, frameOptions.distance)) {
+                std::string str = "Set extra channel distance has failed";
+                throw AnimatedEncoderError(str);
+            }
+        }
+    }
+
+    if (frameOptions.effort >= 0) {
+        if (JxlEncoderFrameSettingsSetOption(settings,
+                                             JXL_ENC_FRAME_SETTING_EFFORT, frameOptions.effort) != JXL_ENC_SUCCESS) {
+            std::string str = "Set effort has failed";
+            throw AnimatedEncoderError(str);
+        }
+    }
+
+    frameSettingsCache[key] = settings;
+    return settings;
+}
+
+void JxlAnimatedEncoder::encodeFrame(std::vector<uint8_t>& data, int frameTime,
+                                     const JxlAnimatedFrameOptions& frameOptions) {
     std::lock_guard guard(lock);
 
     addedFrames += 1;
 
+    // The last frame is always held back, encode() has to submit it after the input is closed
+    // so that libjxl marks it as the last one before it reaches the output sink
+    uint64_t hash = 0;
+    if (coalesceDuplicates) {
+        hash = jxlcoder::JxlFrameHash(data.data(), data.size());
+        if (hasPendingFrame && !frameOptions.keyframe
+            && hash == pendingHash && data.size() == pendingFrame.size()
+            && std::equal(data.begin(), data.end(), pendingFrame.begin())
+            && pendingDuration + std::max(frameTime, 0) <= std::numeric_limits<uint32_t>::max()) {
+            pendingDuration += std::max(frameTime, 0);
+            return;
+        }
+    }
+
+    flushPendingFrame();
+    pendingFrame.assign(data.begin(), data.end());
+    pendingHash = hash;
+    pendingDuration = std::max(frameTime, 0);
+    pendingOptions = frameOptions;
+    hasPendingFrame = true;
+}
+
+void JxlAnimatedEncoder::flushPendingFrame(bool lastFrame) {
+    if (!hasPendingFrame) {
+        return;
+    }
+    hasPendingFrame = false;
+    submitFrame(pendingFrame, static_cast<uint32_t>(pendingDuration), pendingOptions);
+    // The submitted frame becomes the base for the next changed region
+    std::swap(previousFrame, pendingFrame);
+    pendingFrame.clear();
+    if (!cropChangedRegions || !pendingOptions.saveAsReference) {
+        previousFrame.clear();
+    }
+    if (lastFrame) {
+        JxlEncoderCloseInput(enc.get());
+    }
+    flushOutput();
+}
+
+void JxlAnimatedEncoder::submitFrame(std::vector<uint8_t>& data, uint32_t frameTime,
+                                     const JxlAnimatedFrameOptions& frameOptions) {
+    JxlEncoderFrameSettings* settings = getFrameSettings(frameOptions);
+
+    const size_t bytesPerPixel = getBytesPerPixel();
+    const size_t frameSize = bytesPerPixel * width * height;
+
     JxlEncoderInitFrameHeader(&header);
-    header.timecode = 0;
+    header.timecode = timing.haveTimecodes ? frameOptions.timecode : 0;
     header.duration = frameTime;
     header.is_last = false;
+    header.layer_info.have_crop = JXL_FALSE;
     header.layer_info.crop_x0 = 0;
     header.layer_info.crop_y0 = 0;
     header.layer_info.xsize = width;
     header.layer_info.ysize = height;
+    // Every frame keeps its canvas in slot 1 so the next one may replace only what has changed
+    header.layer_info.blend_info.blendmode = JXL_BLEND_REPLACE;
+    header.layer_info.blend_info.source = 1;
+    header.layer_info.save_as_reference = frameOptions.saveAsReference ? 1 : 0;
+
+    const void *pixels = data.data();
+    size_t pixelsSize = sizeof(uint8_t) * data.size();
+
+    const bool canCrop = cropChangedRegions && !frameOptions.keyframe && data.size() == frameSize
+                         && previousFrame.size() == frameSize;
+    if (canCrop) {
+        jxlcoder::JxlChangedRegion region;
+        if (!jxlcoder::JxlFindChangedRegion(previousFrame.data(), data.data(),
+                                            width, height, static_cast<uint32_t>(bytesPerPixel), &region)) {
+            // Nothing has changed, a single pixel keeps the frame valid and the canvas untouched
+            region.x = 0;
+            region.y = 0;
+            region.width = 1;
+            region.height = 1;
+        }
+
+        if (region.width != static_cast<uint32_t>(width) || region.height != static_cast<uint32_t>(height)) {
+            header.layer_info.have_crop = JXL_TRUE;
+            header.layer_info.crop_x0 = static_cast<int32_t>(region.x);
+            header.layer_info.crop_y0 = static_cast<int32_t>(region.y);
+            header.layer_info.xsize = region.width;
+            header.layer_info.ysize = region.height;
 
-    if (JXL_ENC_SUCCESS != JxlEncoderSetFrameHeader(frameSettings, &header)) {
+            const size_t rowSize = region.width * bytesPerPixel;
+            const size_t stride = width * bytesPerPixel;
+            cropBuffer.resize(rowSize * region.height);
+            for (uint32_t y = 0; y < region.height; ++y) {
+                std::copy(data.begin() + (region.y + y) * stride + region.x * bytesPerPixel,
+                          data.begin() + (region.y + y) * stride + region.x * bytesPerPixel + rowSize,
+                          cropBuffer.begin() + y * rowSize);
+            }
+            pixels = cropBuffer.data();
+            pixelsSize = cropBuffer.size();
+        }
+    }
+
+    if (JXL_ENC_SUCCESS != JxlEncoderSetFrameHeader(settings, &header)) {
         std::string str = "Set frame header has failed";
         throw AnimatedEncoderError(str);
     }
 
+    // Names stick to the frame settings, so an empty one clears whatever the last frame used
+    if (JXL_ENC_SUCCESS != JxlEncoderSetFrameName(settings, frameOptions.name.c_str())) {
+        std::string str = "Set frame name has failed";
+        throw AnimatedEncoderError(str);
+    }
+
+    if (basicInfo.num_extra_channels > 0) {
+        if (JXL_ENC_SUCCESS != JxlEncoderSetExtraChannelBlendInfo(settings, 0,
+                                                                  &header.layer_info.blend_info)) {
+            std::string str = "Set extra channel blend info has failed";
+            throw AnimatedEncoderError(str);
+        }
+    }
+
     if (JXL_ENC_SUCCESS !=
-        JxlEncoderAddImageFrame(frameSettings, &pixelFormat,
-                                (void *) data.data(),
-                                sizeof(uint8_t) * data.size())) {
+        JxlEncoderAddImageFrame(settings, &pixelFormat,
+                                pixels, pixelsSize)) {
         std::string str = "Encoding frame has failed";
         throw AnimatedEncoderError(str);
     }
 }
 
 void JxlAnimatedEncoder::encode(std::vector<uint8_t>& dst) {
+    stopAsync(false);
     std::lock_guard guard(lock);
+    if (asyncError) {
+        std::rethrow_exception(asyncError);
+    }
     if (addedFrames == 0) {
         std::string str = "Cannot compress empty animation";
         throw AnimatedEncoderError(str);
     }
-    JxlEncoderCloseFrames(enc.get());
+    // Closing the input before the final flush lets libjxl mark the frame as the last one
+    flushPendingFrame(true);
+
+    if (outputSink) {
+        dst.clear();
+        return;
+    }
 
     dst.resize(64);
     uint8_t *nextOut = dst.data();
@@ -82,5 +413,5 @@ void JxlAnimatedEncoder::encode(std::vector<uint8_t>& dst) {
 }
 
 JxlAnimatedEncoder::~JxlAnimatedEncoder() {
-
+    stopAsync(true);
 }
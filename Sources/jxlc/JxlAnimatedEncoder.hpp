@@ -34,8 +34,17 @@
 #include <jxl/thread_parallel_runner_cxx.h>
 #include <string>
 #include "JxlDefinitions.h"
+#include "JxlEncoderOptions.hpp"
+#include "JxlYuvConverter.hpp"
 #include <vector>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <exception>
+#include <map>
+#include <tuple>
 
 class AnimatedEncoderError : public std::exception {
 public:
@@ -49,14 +58,60 @@ private:
     std::string errorMessage;
 };
 
+/**
+ * Receives encoded bytes as soon as they are final, the buffer is reused after the call returns.
+ * Returning false stops encoding
+ */
+using JxlEncoderOutputSink = std::function<bool(const uint8_t* data, size_t size)>;
+
+/**
+ * Per frame overrides of the animation settings, fields left at -1 keep the values the encoder was created with
+ */
+struct JxlAnimatedFrameOptions {
+    /// Butteraugli distance of the frame, 0...25
+    float distance = -1;
+    /// 1...9
+    int effort = -1;
+    /// 0 or 1, lossless frames require an animation created lossless
+    int lossless = -1;
+    /// Encodes the whole canvas without building on the previous frame and never merges it as a duplicate
+    bool keyframe = false;
+    /// When false no later frame builds on this one, the next frame is then encoded in full
+    bool saveAsReference = true;
+    std::string name;
+    /// SMPTE timecode written when the animation has timecodes enabled, 0xHHMMSSFF
+    uint32_t timecode = 0;
+
+    bool hasSettingsOverrides() const {
+        return distance >= 0 || effort >= 0 || lossless >= 0;
+    }
+};
+
+/**
+ * Frame durations are expressed in ticks, a tick lasts tpsDenominator / tpsNumerator seconds.
+ * The default of 1000 ticks per second keeps durations in milliseconds
+ */
+struct JxlAnimationTiming {
+    uint32_t tpsNumerator = 1000;
+    uint32_t tpsDenominator = 1;
+    bool haveTimecodes = false;
+};
+
 class JxlAnimatedEncoder {
 public:
     JxlAnimatedEncoder(int width, int height, JxlPixelType pixelType, 
                        JxlEncodingPixelFormat encodingPixelFormat, 
                        JxlCompressionOption compressionOption, 
-                       int numLoops, int quality, int effort, int decodingSpeed): width(width), height(height),
+                       int numLoops, int quality, int effort, int decodingSpeed,
+                       const jxlcoder::JxlEncoderOptions &options = jxlcoder::JxlEncoderOptions(),
+                       const JxlAnimationTiming &timing = JxlAnimationTiming(),
+                       JxlEncodingTransfer transfer = etAutomatic): width(width), height(height),
     pixelType(pixelType), encodingPixelFormat(encodingPixelFormat),
-    compressionOption(compressionOption), quality(quality), effort(effort) {
+    compressionOption(compressionOption), quality(quality), effort(effort), timing(timing) {
+        if (timing.tpsNumerator == 0 || timing.tpsDenominator == 0) {
+            std::string str = "Animation timebase must have non-zero numerator and denominator";
+            throw AnimatedEncoderError(str);
+        }
         if (!enc || !runner) {
             std::string str = "Cannot initialize encoder";
             throw AnimatedEncoderError(str);
@@ -76,35 +131,74 @@ public:
             case rgba:
                 pixelFormat = {4, JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
                 break;
+            case gray:
+                pixelFormat = {1, JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
+                break;
+            case grayAlpha:
+                pixelFormat = {2, JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
+                break;
         }
 
-        if (encodingPixelFormat == efloat16) {
-            pixelFormat.data_type = JXL_TYPE_FLOAT16;
-        } else {
-            pixelFormat.data_type = JXL_TYPE_UINT8;
+        const bool hasAlpha = pixelType == rgba || pixelType == grayAlpha;
+
+        uint32_t bitsPerSample = 8;
+        uint32_t exponentBitsPerSample = 0;
+        switch (encodingPixelFormat) {
+            case er8:
+                pixelFormat.data_type = JXL_TYPE_UINT8;
+                break;
+            case er16:
+                pixelFormat.data_type = JXL_TYPE_UINT16;
+                bitsPerSample = 16;
+                break;
+            case efloat16:
+                pixelFormat.data_type = JXL_TYPE_FLOAT16;
+                bitsPerSample = 16;
+                exponentBitsPerSample = 5;
+                break;
+            case efloat32:
+                pixelFormat.data_type = JXL_TYPE_FLOAT;
+                bitsPerSample = 32;
+                exponentBitsPerSample = 8;
+                break;
         }
 
         JxlEncoderInitBasicInfo(&basicInfo);
         basicInfo.xsize = width;
         basicInfo.ysize = height;
-        basicInfo.bits_per_sample = 8;
+        basicInfo.bits_per_sample = bitsPerSample;
+        basicInfo.exponent_bits_per_sample = exponentBitsPerSample;
         basicInfo.uses_original_profile = compressionOption == loosy ? JXL_FALSE : JXL_TRUE;
-        basicInfo.num_color_channels = 3;
+        basicInfo.num_color_channels = pixelFormat.num_channels < 3 ? 1 : 3;
 
-        basicInfo.animation.tps_numerator = 1000;
-        basicInfo.animation.tps_denominator = 1;
+        basicInfo.animation.tps_numerator = timing.tpsNumerator;
+        basicInfo.animation.tps_denominator = timing.tpsDenominator;
         basicInfo.animation.num_loops = static_cast<uint32_t>(numLoops);
-        basicInfo.animation.have_timecodes = false;
+        basicInfo.animation.have_timecodes = timing.haveTimecodes;
         basicInfo.have_animation = true;
 
-        if (JXL_ENC_SUCCESS != JxlEncoderSetCodestreamLevel(enc.get(), 10)) {
+        if (JXL_ENC_SUCCESS != JxlEncoderSetCodestreamLevel(enc.get(),
+                                                            options.codestreamLevel >= 0 ? options.codestreamLevel : 10)) {
             std::string str = "Cannot set codestream level";
             throw AnimatedEncoderError(str);
         }
 
-        if (pixelType == rgba) {
+        if (hasAlpha) {
             basicInfo.num_extra_channels = 1;
-            basicInfo.alpha_bits = 8;
+            basicInfo.alpha_bits = bitsPerSample;
+            basicInfo.alpha_exponent_bits = exponentBitsPerSample;
+        }
+
+        if (transfer == etAutomatic) {
+            // Float input is usually scene linear HDR, values outside 0...1 are kept
+            const bool floatSamples = encodingPixelFormat == efloat16 || encodingPixelFormat == efloat32;
+            transfer = floatSamples ? etLinear : etSRGB;
+        }
+        this->transfer = transfer;
+        if (transfer == etPQ) {
+            basicInfo.intensity_target = 10000;
+        } else if (transfer == etHLG) {
+            basicInfo.intensity_target = 1000;
         }
 
         if (JXL_ENC_SUCCESS != JxlEncoderSetBasicInfo(enc.get(), &basicInfo)) {
@@ -116,11 +210,15 @@ public:
             case rgb:
                 basicInfo.num_color_channels = 3;
                 break;
+            case gray:
+                basicInfo.num_color_channels = 1;
+                break;
             case rgba:
-                basicInfo.num_color_channels = 4;
+            case grayAlpha:
                 JxlExtraChannelInfo channelInfo;
                 JxlEncoderInitExtraChannelInfo(JXL_CHANNEL_ALPHA, &channelInfo);
-                channelInfo.bits_per_sample = 8;
+                channelInfo.bits_per_sample = bitsPerSample;
+                channelInfo.exponent_bits_per_sample = exponentBitsPerSample;
                 channelInfo.alpha_premultiplied = false;
                 if (JXL_ENC_SUCCESS != JxlEncoderSetExtraChannelInfo(enc.get(), 0, &channelInfo)) {
                     std::string str = "Cannot set extra channel to encoder";
@@ -131,6 +229,23 @@ public:
 
         JxlColorEncoding colorEncoding = {};
         JxlColorEncodingSetToSRGB(&colorEncoding, pixelFormat.num_channels < 3);
+        switch (transfer) {
+            case etLinear:
+                colorEncoding.transfer_function = JXL_TRANSFER_FUNCTION_LINEAR;
+                break;
+            case etPQ:
+                colorEncoding.transfer_function = JXL_TRANSFER_FUNCTION_PQ;
+                colorEncoding.primaries = JXL_PRIMARIES_2100;
+                colorEncoding.rendering_intent = JXL_RENDERING_INTENT_RELATIVE;
+                break;
+            case etHLG:
+                colorEncoding.transfer_function = JXL_TRANSFER_FUNCTION_HLG;
+                colorEncoding.primaries = JXL_PRIMARIES_2100;
+                colorEncoding.rendering_intent = JXL_RENDERING_INTENT_RELATIVE;
+                break;
+            default:
+                break;
+        }
         if (JXL_ENC_SUCCESS !=
             JxlEncoderSetColorEncoding(enc.get(), &colorEncoding)) {
             std::string str = "Cannot set color encoding";
@@ -141,13 +256,8 @@ public:
                 JxlEncoderFrameSettingsCreate(enc.get(), nullptr);
 
         JxlBitDepth depth;
-        if (encodingPixelFormat == efloat16) {
-            depth.bits_per_sample = 16;
-            depth.exponent_bits_per_sample = 5;
-        } else {
-            depth.bits_per_sample = 8;
-            depth.exponent_bits_per_sample = 0;
-        }
+        depth.bits_per_sample = bitsPerSample;
+        depth.exponent_bits_per_sample = exponentBitsPerSample;
         depth.type = JXL_BIT_DEPTH_FROM_PIXEL_FORMAT;
 
         if (JXL_ENC_SUCCESS != JxlEncoderSetFrameBitDepth(frameSettings, &depth)) {
@@ -172,7 +282,7 @@ public:
             throw AnimatedEncoderError(str);
         }
 
-        if (pixelType == rgba) {
+        if (hasAlpha) {
             if (JXL_ENC_SUCCESS !=
                        JxlEncoderSetExtraChannelDistance(frameSettings, 0, JXLGetDistance(quality))) {
                 std::string str = "Set extra channel distance has failed";
@@ -186,12 +296,65 @@ public:
             throw AnimatedEncoderError(str);
         }
 
+        if (!jxlcoder::ApplyFrameOptions(frameSettings, options)) {
+            std::string str = "Set encoder options has failed";
+            throw AnimatedEncoderError(str);
+        }
+
 
     }
 
-    void addFrame(std::vector<uint8_t>& data, int frameTime);
+    /**
+     * @param frameTime duration in ticks of the animation timebase, milliseconds by default
+     */
+    void addFrame(std::vector<uint8_t>& data, int frameTime,
+                  const JxlAnimatedFrameOptions& frameOptions = JxlAnimatedFrameOptions());
+    void addFrame(std::vector<uint8_t>&& data, int frameTime,
+                  const JxlAnimatedFrameOptions& frameOptions = JxlAnimatedFrameOptions());
+    /**
+     * Converts a 4:2:0 frame on the calling thread, split into row stripes, and adds it as RGB or RGBA.
+     * Requires an 8 or 16-bit animation with RGB or RGBA pixel type
+     * @param numThreads 0 uses every available core
+     */
+    void addYuvFrame(const jxlcoder::JxlYuvFrame& frame, int frameTime,
+                     const JxlAnimatedFrameOptions& frameOptions = JxlAnimatedFrameOptions(),
+                     int numThreads = 0);
+
+    /**
+     * When an output sink is set the encoded bytes are streamed into it and dst stays empty
+     */
     void encode(std::vector<uint8_t>& dst);
 
+    /**
+     * Moves encoding to a dedicated thread, addFrame only queues the frame
+     * and blocks while queueCapacity frames are already waiting
+     */
+    void startAsync(size_t queueCapacity);
+
+    /**
+     * Streams output after every encoded frame instead of collecting it in encode,
+     * must be set before the first frame is added
+     */
+    void setOutputSink(JxlEncoderOutputSink sink);
+
+    /**
+     * When enabled each frame after the first one encodes only the bounding box of pixels
+     * that differ from the previous frame, and blends it over the previous canvas
+     */
+    void setCropChangedRegions(bool enabled) {
+        std::lock_guard guard(lock);
+        cropChangedRegions = enabled;
+    }
+
+    /**
+     * When enabled a frame identical to the previous one is not encoded,
+     * its duration is added to the previous frame instead
+     */
+    void setCoalesceDuplicates(bool enabled) {
+        std::lock_guard guard(lock);
+        coalesceDuplicates = enabled;
+    }
+
     int getWidth() {
         return width;
     }
@@ -204,10 +367,32 @@ public:
         return pixelFormat;
     }
 
+    JxlEncodingPixelFormat getEncodingPixelFormat() {
+        return encodingPixelFormat;
+    }
+
+    /**
+     * Transfer function the animation is tagged with, never etAutomatic
+     */
+    JxlEncodingTransfer getTransfer() const {
+        return transfer;
+    }
+
+    /**
+     * Size in bytes every frame passed to addFrame must have
+     */
+    size_t getFrameSize() {
+        return getBytesPerPixel() * width * height;
+    }
+
     JxlPixelType getJxlPixelType() {
         return pixelType;
     }
 
+    const JxlAnimationTiming& getTiming() const {
+        return timing;
+    }
+
     ~JxlAnimatedEncoder();
 private:
     const int width;
@@ -217,9 +402,71 @@ private:
     const JxlPixelType pixelType;
     const JxlEncodingPixelFormat encodingPixelFormat;
     const JxlCompressionOption compressionOption;
+    const JxlAnimationTiming timing;
+    JxlEncodingTransfer transfer = etSRGB;
     JxlPixelFormat pixelFormat;
     int addedFrames = 0;
 
+    bool cropChangedRegions = true;
+    std::vector<uint8_t> previousFrame;
+    std::vector<uint8_t> cropBuffer;
+
+    // Submission lags one frame behind so duplicates can still extend its duration
+    // and the last frame is only submitted once the input is closed
+    bool coalesceDuplicates = true;
+    bool hasPendingFrame = false;
+    std::vector<uint8_t> pendingFrame;
+    uint64_t pendingHash = 0;
+    uint64_t pendingDuration = 0;
+    JxlAnimatedFrameOptions pendingOptions;
+
+    void submitFrame(std::vector<uint8_t>& data, uint32_t frameTime, const JxlAnimatedFrameOptions& frameOptions);
+    void flushPendingFrame(bool lastFrame = false);
+    void encodeFrame(std::vector<uint8_t>& data, int frameTime, const JxlAnimatedFrameOptions& frameOptions);
+
+    // Frame settings are owned by the encoder, one is created for every distinct override set
+    std::map<std::tuple<float, int, int>, JxlEncoderFrameSettings*> frameSettingsCache;
+    JxlEncoderFrameSettings* getFrameSettings(const JxlAnimatedFrameOptions& frameOptions);
+
+    JxlEncoderOutputSink outputSink;
+    std::vector<uint8_t> outputChunk;
+    bool outputFailed = false;
+    void flushOutput();
+
+    static void* getOutputBuffer(void* opaque, size_t* size);
+    static void releaseOutputBuffer(void* opaque, size_t writtenBytes);
+    static void setFinalizedPosition(void* opaque, uint64_t finalizedPosition);
+
+    struct QueuedFrame {
+        std::vector<uint8_t> data;
+        int frameTime;
+        JxlAnimatedFrameOptions frameOptions;
+    };
+
+    std::thread worker;
+    std::mutex queueLock;
+    std::condition_variable queueChanged;
+    std::deque<QueuedFrame> queue;
+    size_t queueCapacity = 0;
+    bool asyncStarted = false;
+    bool queueClosed = false;
+    std::exception_ptr asyncError;
+
+    void asyncWorker();
+    void stopAsync(bool discardQueued);
+
+    size_t getBytesPerPixel() {
+        switch (pixelFormat.data_type) {
+            case JXL_TYPE_UINT16:
+            case JXL_TYPE_FLOAT16:
+                return pixelFormat.num_channels * 2;
+            case JXL_TYPE_FLOAT:
+                return pixelFormat.num_channels * 4;
+            default:
+                return pixelFormat.num_channels;
+        }
+    }
+
     JxlEncoderPtr enc = JxlEncoderMake(nullptr);
     JxlThreadParallelRunnerPtr runner = JxlThreadParallelRunnerMake(nullptr,
                                                                     JxlThreadParallelRunnerDefaultNumWorkerThreads());
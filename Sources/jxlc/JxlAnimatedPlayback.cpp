@@ -0,0 +1,180 @@
+//
+//  JxlAnimatedPlayback.cpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#include "JxlAnimatedPlayback.hpp"
+#include <algorithm>
+#include <chrono>
+
+JxlAnimatedPlayback::JxlAnimatedPlayback(JxlAnimatedDecoder& decoder, int lookahead, size_t memoryLimit)
+: decoder(decoder) {
+    size_t capacity = static_cast<size_t>(std::max(lookahead, 1));
+    const size_t frameSize = decoder.getFrameSize();
+    if (memoryLimit > 0 && frameSize > 0) {
+        capacity = std::clamp(memoryLimit / frameSize, static_cast<size_t>(1), capacity);
+    }
+    ring.resize(capacity);
+    worker = std::thread(&JxlAnimatedPlayback::run, this);
+}
+
+JxlAnimatedPlayback::~JxlAnimatedPlayback() {
+    {
+        std::lock_guard guard(mutex);
+        stopped = true;
+    }
+    slotFree.notify_all();
+    frameReady.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void JxlAnimatedPlayback::run() {
+    // 0 loops forever, negative is a still image played once
+    const int loops = decoder.getLoopCount();
+    int frame = 0;
+    int loop = 0;
+
+    // Frames are checked one by one, the header scan isn't forced before the first frame
+    bool available;
+    if (!frameAvailable(frame, &available)) {
+        return;
+    }
+    while (available) {
+        Slot* slot;
+        {
+            std::unique_lock guard(mutex);
+            slotFree.wait(guard, [this] { return stopped || count < ring.size(); });
+            if (stopped) {
+                return;
+            }
+            // Only the worker writes past the tail, so the slot can be filled unlocked
+            slot = &ring[(head + count) % ring.size()];
+        }
+
+        int duration;
+        auto start = std::chrono::steady_clock::now();
+        try {
+            duration = decoder.getFrame(frame, slot->pixels);
+        } catch (AnimatedDecoderError& err) {
+            fail(err.what());
+            return;
+        } catch (std::bad_alloc& err) {
+            fail(err.what());
+            return;
+        }
+        const double decodeTime = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+
+        {
+            std::lock_guard guard(mutex);
+            slot->frame = frame;
+            slot->duration = duration;
+            count += 1;
+
+            statistics.decodedFrames += 1;
+            if (duration > 0 && decodeTime > duration) {
+                statistics.slowFrames += 1;
+            }
+            statistics.maxDecodeTime = std::max(statistics.maxDecodeTime, decodeTime);
+            decodeTimeSum += decodeTime;
+            durationSum += duration;
+        }
+        frameReady.notify_one();
+
+        frame += 1;
+        if (!frameAvailable(frame, &available)) {
+            return;
+        }
+        if (!available) {
+            frame = 0;
+            loop += 1;
+            if (loops < 0 || (loops > 0 && loop >= loops)) {
+                break;
+            }
+            available = true;
+        }
+    }
+
+    std::lock_guard guard(mutex);
+    finished = true;
+    frameReady.notify_all();
+}
+
+bool JxlAnimatedPlayback::frameAvailable(int frame, bool* available) {
+    try {
+        *available = decoder.hasFrame(frame);
+        return true;
+    } catch (AnimatedDecoderError& err) {
+        fail(err.what());
+    } catch (std::bad_alloc& err) {
+        fail(err.what());
+    }
+    return false;
+}
+
+void JxlAnimatedPlayback::fail(const std::string& message) {
+    std::lock_guard guard(mutex);
+    errorMessage = message;
+    finished = true;
+    frameReady.notify_all();
+}
+
+bool JxlAnimatedPlayback::nextFrame(std::vector<uint8_t>& pixels, int* frameIndex, int* duration) {
+    std::unique_lock guard(mutex);
+    if (count == 0 && !finished) {
+        statistics.underruns += 1;
+    }
+    frameReady.wait(guard, [this] { return stopped || finished || count > 0; });
+    if (count == 0) {
+        if (!errorMessage.empty()) {
+            throw AnimatedDecoderError(errorMessage);
+        }
+        return false;
+    }
+
+    Slot& slot = ring[head];
+    pixels.swap(slot.pixels);
+    if (frameIndex) {
+        *frameIndex = slot.frame;
+    }
+    if (duration) {
+        *duration = slot.duration;
+    }
+    head = (head + 1) % ring.size();
+    count -= 1;
+    guard.unlock();
+    slotFree.notify_one();
+    return true;
+}
+
+JxlPlaybackStatistics JxlAnimatedPlayback::getStatistics() {
+    std::lock_guard guard(mutex);
+    JxlPlaybackStatistics result = statistics;
+    if (result.decodedFrames > 0) {
+        result.meanDecodeTime = decodeTimeSum / result.decodedFrames;
+        result.meanFrameDuration = durationSum / result.decodedFrames;
+    }
+    return result;
+}
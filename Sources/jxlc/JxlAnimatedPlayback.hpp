@@ -0,0 +1,113 @@
+//
+//  JxlAnimatedPlayback.hpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#ifndef JxlAnimatedPlayback_hpp
+#define JxlAnimatedPlayback_hpp
+
+#ifdef __cplusplus
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "JxlAnimatedDecoder.hpp"
+
+struct JxlPlaybackStatistics {
+    int decodedFrames = 0;
+    /// Frames that took longer to decode than they are displayed
+    int slowFrames = 0;
+    /// Times the consumer had to wait on an empty ring
+    int underruns = 0;
+    /// Decode time per frame, in milliseconds
+    double meanDecodeTime = 0;
+    double maxDecodeTime = 0;
+    /// Display duration per decoded frame, in milliseconds
+    double meanFrameDuration = 0;
+};
+
+/**
+ * Decodes frames ahead of playback on a background thread into a ring of reusable buffers.
+ * Frames are produced in display order and wrap at the end of the animation until
+ * the loop count of the file is exhausted.
+ * The decoder must not be used by anyone else while the playback is alive.
+ */
+class JxlAnimatedPlayback {
+public:
+    /**
+     * @param lookahead frames decoded ahead of the consumer
+     * @param memoryLimit bytes the ring may hold, 0 means no limit; at least one frame is always kept
+     */
+    JxlAnimatedPlayback(JxlAnimatedDecoder& decoder, int lookahead = 3, size_t memoryLimit = 0);
+    ~JxlAnimatedPlayback();
+
+    /**
+     * Waits for the next frame in display order and swaps its pixels into `pixels`.
+     * The buffer previously held by the caller goes back into the ring.
+     * @return false when all loops were played
+     */
+    bool nextFrame(std::vector<uint8_t>& pixels, int* frameIndex, int* duration);
+
+    JxlPlaybackStatistics getStatistics();
+
+    int getCapacity() const {
+        return static_cast<int>(ring.size());
+    }
+
+private:
+    struct Slot {
+        std::vector<uint8_t> pixels;
+        int frame = 0;
+        int duration = 0;
+    };
+
+    void run();
+    /**
+     * The header scan behind hasFrame can throw on a corrupt file
+     * @return false when the playback has failed, the error is already reported
+     */
+    bool frameAvailable(int frame, bool* available);
+    void fail(const std::string& message);
+
+    JxlAnimatedDecoder& decoder;
+    std::vector<Slot> ring;
+    size_t head = 0;
+    size_t count = 0;
+    bool stopped = false;
+    bool finished = false;
+    std::string errorMessage;
+    JxlPlaybackStatistics statistics;
+    double decodeTimeSum = 0;
+    double durationSum = 0;
+    std::mutex mutex;
+    std::condition_variable frameReady;
+    std::condition_variable slotFree;
+    std::thread worker;
+};
+
+#endif
+
+#endif /* JxlAnimatedPlayback_hpp */
@@ -0,0 +1,926 @@
+//
+//  JxlAnimationImporter.cpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#include "JxlAnimationImporter.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <zlib.h>
+
+static const uint64_t kMaxImportPixels = 1ull << 28;
+
+static void ThrowImportError(const char* message) {
+    std::string str = message;
+    throw AnimationImportError(str);
+}
+
+/**
+ * Bounds checked cursor over the borrowed source bytes
+ */
+class JxlByteCursor {
+public:
+    JxlByteCursor(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+    bool atEnd() const {
+        return pos >= size;
+    }
+
+    size_t remaining() const {
+        return size - pos;
+    }
+
+    const uint8_t* current() const {
+        return data + pos;
+    }
+
+    void require(size_t count) const {
+        if (remaining() < count) {
+            ThrowImportError("Unexpected end of file");
+        }
+    }
+
+    uint8_t u8() {
+        require(1);
+        return data[pos++];
+    }
+
+    uint16_t le16() {
+        require(2);
+        const uint16_t value = data[pos] | (data[pos + 1] << 8);
+        pos += 2;
+        return value;
+    }
+
+    uint16_t be16() {
+        require(2);
+        const uint16_t value = (data[pos] << 8) | data[pos + 1];
+        pos += 2;
+        return value;
+    }
+
+    uint32_t be32() {
+        require(4);
+        const uint32_t value = (static_cast<uint32_t>(data[pos]) << 24) | (data[pos + 1] << 16)
+                               | (data[pos + 2] << 8) | data[pos + 3];
+        pos += 4;
+        return value;
+    }
+
+    void skip(size_t count) {
+        require(count);
+        pos += count;
+    }
+
+    size_t pos = 0;
+
+private:
+    const uint8_t* data;
+    size_t size;
+};
+
+/**
+ * What happens to the region of a frame once it has been displayed
+ */
+class JxlFrameDisposal {
+public:
+    enum Mode {
+        keep = 0,
+        clear = 1,
+        restore = 2
+    };
+
+    void prepare(Mode newMode, const std::vector<uint8_t>& canvas, uint32_t canvasWidth,
+                 uint32_t rx, uint32_t ry, uint32_t rw, uint32_t rh) {
+        mode = newMode;
+        x = rx;
+        y = ry;
+        width = rw;
+        height = rh;
+        if (mode == restore) {
+            saved.resize(static_cast<size_t>(width) * height * 4);
+            for (uint32_t row = 0; row < height; ++row) {
+                const uint8_t* src = canvas.data() + ((y + row) * static_cast<size_t>(canvasWidth) + x) * 4;
+                std::copy(src, src + width * 4, saved.begin() + row * static_cast<size_t>(width) * 4);
+            }
+        }
+    }
+
+    void apply(std::vector<uint8_t>& canvas, uint32_t canvasWidth) {
+        for (uint32_t row = 0; row < height && mode != keep; ++row) {
+            uint8_t* dst = canvas.data() + ((y + row) * static_cast<size_t>(canvasWidth) + x) * 4;
+            if (mode == clear) {
+                std::fill(dst, dst + width * 4, 0);
+            } else {
+                const uint8_t* src = saved.data() + row * static_cast<size_t>(width) * 4;
+                std::copy(src, src + width * 4, dst);
+            }
+        }
+        mode = keep;
+    }
+
+private:
+    Mode mode = keep;
+    uint32_t x = 0, y = 0, width = 0, height = 0;
+    std::vector<uint8_t> saved;
+};
+
+class JxlAnimationReader {
+public:
+    virtual ~JxlAnimationReader() = default;
+
+    /**
+     * Composites the next frame into canvas, which is width * height RGBA8
+     */
+    virtual bool nextFrame(std::vector<uint8_t>& canvas, int* duration) = 0;
+
+    uint32_t width = 0;
+    uint32_t height = 0;
+    int loopCount = 0;
+};
+
+// MARK: - GIF
+
+class JxlGifReader : public JxlAnimationReader {
+public:
+    JxlGifReader(const uint8_t* data, size_t size) : cursor(data, size) {
+        cursor.require(13);
+        if (std::memcmp(cursor.current(), "GIF87a", 6) != 0 && std::memcmp(cursor.current(), "GIF89a", 6) != 0) {
+            ThrowImportError("Invalid GIF signature");
+        }
+        cursor.skip(6);
+        width = cursor.le16();
+        height = cursor.le16();
+        const uint8_t packed = cursor.u8();
+        cursor.skip(2);
+        if (packed & 0x80) {
+            readPalette(globalPalette, 2u << (packed & 0x07));
+        }
+        if (width == 0 || height == 0 || static_cast<uint64_t>(width) * height > kMaxImportPixels) {
+            ThrowImportError("Invalid GIF dimensions");
+        }
+        // GIFs without the NETSCAPE extension play once, it precedes the first image when present
+        loopCount = 1;
+        findLoopCount();
+    }
+
+    bool nextFrame(std::vector<uint8_t>& canvas, int* duration) override {
+        if (finished) {
+            return false;
+        }
+        try {
+            return readFrame(canvas, duration);
+        } catch (AnimationImportError&) {
+            // Truncated GIFs are common, keep what was decoded so far
+            finished = true;
+            if (framesRead == 0) {
+                throw;
+            }
+            return false;
+        }
+    }
+
+private:
+    JxlByteCursor cursor;
+    std::vector<uint8_t> globalPalette;
+    std::vector<uint8_t> localPalette;
+    std::vector<uint8_t> lzwData;
+    std::vector<uint8_t> indices;
+    JxlFrameDisposal disposal;
+    int framesRead = 0;
+    bool finished = false;
+
+    void readPalette(std::vector<uint8_t>& palette, uint32_t entries) {
+        cursor.require(entries * 3);
+        palette.assign(cursor.current(), cursor.current() + entries * 3);
+        cursor.skip(entries * 3);
+    }
+
+    void skipSubBlocks() {
+        while (true) {
+            const uint8_t blockSize = cursor.u8();
+            if (blockSize == 0) {
+                return;
+            }
+            cursor.skip(blockSize);
+        }
+    }
+
+    void findLoopCount() {
+        const size_t start = cursor.pos;
+        try {
+            while (!cursor.atEnd()) {
+                const uint8_t block = cursor.u8();
+                if (block != 0x21) {
+                    break;
+                }
+                const uint8_t label = cursor.u8();
+                if (label != 0xFF) {
+                    skipSubBlocks();
+                    continue;
+                }
+                const uint8_t identSize = cursor.u8();
+                cursor.require(identSize);
+                const bool looping = identSize >= 11 && (std::memcmp(cursor.current(), "NETSCAPE2.0", 11) == 0
+                                                         || std::memcmp(cursor.current(), "ANIMEXTS1.0", 11) == 0);
+                cursor.skip(identSize);
+                while (true) {
+                    const uint8_t blockSize = cursor.u8();
+                    if (blockSize == 0) {
+                        break;
+                    }
+                    cursor.require(blockSize);
+                    if (looping && blockSize >= 3 && cursor.current()[0] == 1) {
+                        const uint16_t repeats = cursor.current()[1] | (cursor.current()[2] << 8);
+                        // The extension counts repetitions after the first play
+                        loopCount = repeats == 0 ? 0 : repeats + 1;
+                    }
+                    cursor.skip(blockSize);
+                }
+            }
+        } catch (AnimationImportError&) {
+        }
+        cursor.pos = start;
+    }
+
+    bool readFrame(std::vector<uint8_t>& canvas, int* duration) {
+        int delay = 0;
+        int disposalMode = 0;
+        int transparent = -1;
+
+        while (true) {
+            if (cursor.atEnd()) {
+                finished = true;
+                return false;
+            }
+            const uint8_t block = cursor.u8();
+            if (block == 0x21) {
+                const uint8_t label = cursor.u8();
+                if (label == 0xF9) {
+                    const uint8_t blockSize = cursor.u8();
+                    if (blockSize >= 4) {
+                        const uint8_t packed = cursor.u8();
+                        delay = cursor.le16();
+                        const uint8_t transparentIndex = cursor.u8();
+                        transparent = (packed & 0x01) ? transparentIndex : -1;
+                        disposalMode = (packed >> 2) & 0x07;
+                        cursor.skip(blockSize - 4);
+                    } else {
+                        cursor.skip(blockSize);
+                    }
+                }
+                skipSubBlocks();
+            } else if (block == 0x2C) {
+                readImage(canvas, disposalMode, transparent);
+                // Browsers show frames with a delay below 20ms for 100ms
+                *duration = delay < 2 ? 100 : delay * 10;
+                framesRead += 1;
+                return true;
+            } else {
+                finished = true;
+                return false;
+            }
+        }
+    }
+
+    void readImage(std::vector<uint8_t>& canvas, int disposalMode, int transparent) {
+        const uint32_t left = cursor.le16();
+        const uint32_t top = cursor.le16();
+        const uint32_t frameWidth = cursor.le16();
+        const uint32_t frameHeight = cursor.le16();
+        const uint8_t packed = cursor.u8();
+        const bool interlaced = packed & 0x40;
+
+        const std::vector<uint8_t>* palette = &globalPalette;
+        if (packed & 0x80) {
+            readPalette(localPalette, 2u << (packed & 0x07));
+            palette = &localPalette;
+        }
+
+        const uint8_t minCodeSize = cursor.u8();
+        lzwData.clear();
+        while (true) {
+            const uint8_t blockSize = cursor.u8();
+            if (blockSize == 0) {
+                break;
+            }
+            cursor.require(blockSize);
+            lzwData.insert(lzwData.end(), cursor.current(), cursor.current() + blockSize);
+            cursor.skip(blockSize);
+        }
+
+        // Descriptors aren't bound by the screen size, a huge one must not force a huge allocation
+        if (static_cast<uint64_t>(frameWidth) * frameHeight > kMaxImportPixels) {
+            ThrowImportError("Invalid GIF frame dimensions");
+        }
+        const size_t pixels = static_cast<size_t>(frameWidth) * frameHeight;
+        indices.assign(pixels, transparent >= 0 ? static_cast<uint8_t>(transparent) : 0);
+        const size_t decoded = decodeLzw(minCodeSize, indices.data(), pixels);
+
+        disposal.apply(canvas, width);
+
+        const uint32_t x0 = std::min(left, width);
+        const uint32_t y0 = std::min(top, height);
+        const uint32_t x1 = std::min(left + frameWidth, width);
+        const uint32_t y1 = std::min(top + frameHeight, height);
+
+        JxlFrameDisposal::Mode mode = JxlFrameDisposal::keep;
+        if (disposalMode == 2) {
+            mode = JxlFrameDisposal::clear;
+        } else if (disposalMode == 3) {
+            mode = JxlFrameDisposal::restore;
+        }
+        disposal.prepare(mode, canvas, width, x0, y0, x1 - x0, y1 - y0);
+
+        const size_t paletteEntries = palette->size() / 3;
+        for (uint32_t row = 0; row < frameHeight; ++row) {
+            const uint32_t y = top + (interlaced ? interlacedRow(row, frameHeight) : row);
+            if (y >= height || left >= width) {
+                continue;
+            }
+            const uint8_t* src = indices.data() + static_cast<size_t>(row) * frameWidth;
+            if (static_cast<size_t>(row) * frameWidth >= decoded) {
+                break;
+            }
+            uint8_t* dst = canvas.data() + (static_cast<size_t>(y) * width + left) * 4;
+            for (uint32_t x = 0; x < frameWidth && left + x < width; ++x) {
+                const uint8_t index = src[x];
+                if (index == transparent || index >= paletteEntries) {
+                    continue;
+                }
+                dst[x * 4] = (*palette)[index * 3];
+                dst[x * 4 + 1] = (*palette)[index * 3 + 1];
+                dst[x * 4 + 2] = (*palette)[index * 3 + 2];
+                dst[x * 4 + 3] = 255;
+            }
+        }
+    }
+
+    static uint32_t interlacedRow(uint32_t row, uint32_t frameHeight) {
+        // Passes start at rows 0, 4, 2, 1 with steps of 8, 8, 4, 2
+        const uint32_t pass1 = (frameHeight + 7) / 8;
+        const uint32_t pass2 = (frameHeight + 3) / 8;
+        const uint32_t pass3 = (frameHeight + 1) / 4;
+        if (row < pass1) {
+            return row * 8;
+        }
+        row -= pass1;
+        if (row < pass2) {
+            return 4 + row * 8;
+        }
+        row -= pass2;
+        if (row < pass3) {
+            return 2 + row * 4;
+        }
+        row -= pass3;
+        return 1 + row * 2;
+    }
+
+    /**
+     * @return count of decoded indices, corrupt streams end early
+     */
+    size_t decodeLzw(uint8_t minCodeSize, uint8_t* out, size_t capacity) {
+        if (minCodeSize < 1 || minCodeSize > 11) {
+            ThrowImportError("Invalid LZW code size");
+        }
+        uint16_t prefix[4096];
+        uint8_t suffix[4096];
+        uint8_t stack[4097];
+
+        const int clearCode = 1 << minCodeSize;
+        const int endCode = clearCode + 1;
+        for (int i = 0; i < clearCode; ++i) {
+            prefix[i] = 0;
+            suffix[i] = static_cast<uint8_t>(i);
+        }
+
+        int codeSize = minCodeSize + 1;
+        int nextCode = clearCode + 2;
+        int previous = -1;
+        uint8_t first = 0;
+
+        uint32_t bits = 0;
+        int bitCount = 0;
+        size_t position = 0;
+        size_t written = 0;
+
+        while (written < capacity) {
+            while (bitCount < codeSize && position < lzwData.size()) {
+                bits |= static_cast<uint32_t>(lzwData[position++]) << bitCount;
+                bitCount += 8;
+            }
+            if (bitCount < codeSize) {
+                break;
+            }
+            int code = static_cast<int>(bits & ((1u << codeSize) - 1));
+            bits >>= codeSize;
+            bitCount -= codeSize;
+
+            if (code == clearCode) {
+                codeSize = minCodeSize + 1;
+                nextCode = clearCode + 2;
+                previous = -1;
+                continue;
+            }
+            if (code == endCode) {
+                break;
+            }
+            if (previous < 0) {
+                if (code >= clearCode) {
+                    break;
+                }
+                out[written++] = suffix[code];
+                first = suffix[code];
+                previous = code;
+                continue;
+            }
+
+            const int incoming = code;
+            int top = 0;
+            if (code >= nextCode) {
+                if (code > nextCode) {
+                    break;
+                }
+                stack[top++] = first;
+                code = previous;
+            }
+            while (code >= clearCode) {
+                stack[top++] = suffix[code];
+                code = prefix[code];
+            }
+            first = suffix[code];
+            stack[top++] = first;
+
+            while (top > 0 && written < capacity) {
+                out[written++] = stack[--top];
+            }
+
+            if (nextCode < 4096) {
+                prefix[nextCode] = static_cast<uint16_t>(previous);
+                suffix[nextCode] = first;
+                nextCode += 1;
+                if (nextCode == (1 << codeSize) && codeSize < 12) {
+                    codeSize += 1;
+                }
+            }
+            previous = incoming;
+        }
+        return written;
+    }
+};
+
+// MARK: - APNG
+
+static uint32_t JxlChunkType(const char* name) {
+    return (static_cast<uint32_t>(name[0]) << 24) | (name[1] << 16) | (name[2] << 8) | name[3];
+}
+
+class JxlApngReader : public JxlAnimationReader {
+public:
+    JxlApngReader(const uint8_t* data, size_t size) : cursor(data, size) {
+        static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+        cursor.require(8);
+        if (std::memcmp(cursor.current(), signature, 8) != 0) {
+            ThrowImportError("Invalid PNG signature");
+        }
+        cursor.skip(8);
+
+        const uint32_t ihdrLength = cursor.be32();
+        if (cursor.be32() != JxlChunkType("IHDR") || ihdrLength < 13) {
+            ThrowImportError("PNG must start with IHDR");
+        }
+        width = cursor.be32();
+        height = cursor.be32();
+        bitDepth = cursor.u8();
+        colorType = cursor.u8();
+        cursor.skip(2);
+        const uint8_t interlace = cursor.u8();
+        cursor.skip(ihdrLength - 13 + 4);
+
+        if (width == 0 || height == 0 || static_cast<uint64_t>(width) * height > kMaxImportPixels) {
+            ThrowImportError("Invalid PNG dimensions");
+        }
+        if (interlace != 0) {
+            ThrowImportError("Interlaced PNG is not supported");
+        }
+        switch (colorType) {
+            case 0:
+                channels = 1;
+                break;
+            case 2:
+                channels = 3;
+                break;
+            case 3:
+                channels = 1;
+                break;
+            case 4:
+                channels = 2;
+                break;
+            case 6:
+                channels = 4;
+                break;
+            default:
+                ThrowImportError("Invalid PNG color type");
+        }
+        const bool validDepth = (colorType == 0 && (bitDepth == 1 || bitDepth == 2 || bitDepth == 4 || bitDepth == 8 || bitDepth == 16))
+                                || (colorType == 3 && (bitDepth == 1 || bitDepth == 2 || bitDepth == 4 || bitDepth == 8))
+                                || ((colorType == 2 || colorType == 4 || colorType == 6) && (bitDepth == 8 || bitDepth == 16));
+        if (!validDepth) {
+            ThrowImportError("Invalid PNG bit depth");
+        }
+
+        framesStart = cursor.pos;
+        readHeaderChunks();
+        cursor.pos = framesStart;
+        loopCount = animated ? static_cast<int>(std::min(numPlays, static_cast<uint32_t>(std::numeric_limits<int>::max()))) : 1;
+    }
+
+    bool nextFrame(std::vector<uint8_t>& canvas, int* duration) override {
+        FrameControl control;
+        if (!findFrameControl(control)) {
+            return false;
+        }
+        collectFrameData();
+        decodeFrame(control);
+
+        disposal.apply(canvas, width);
+
+        JxlFrameDisposal::Mode mode = JxlFrameDisposal::keep;
+        if (control.dispose == 1 || (control.dispose == 2 && framesRead == 0)) {
+            mode = JxlFrameDisposal::clear;
+        } else if (control.dispose == 2) {
+            mode = JxlFrameDisposal::restore;
+        }
+        disposal.prepare(mode, canvas, width, control.x, control.y, control.width, control.height);
+
+        for (uint32_t row = 0; row < control.height; ++row) {
+            const uint8_t* src = frame.data() + static_cast<size_t>(row) * control.width * 4;
+            uint8_t* dst = canvas.data() + ((control.y + row) * static_cast<size_t>(width) + control.x) * 4;
+            if (control.blend == 0) {
+                std::copy(src, src + control.width * 4, dst);
+                continue;
+            }
+            for (uint32_t x = 0; x < control.width; ++x, src += 4, dst += 4) {
+                const uint32_t sa = src[3];
+                if (sa == 255) {
+                    std::copy(src, src + 4, dst);
+                } else if (sa != 0) {
+                    const uint32_t da = dst[3] * (255 - sa) / 255;
+                    const uint32_t outA = sa + da;
+                    for (int c = 0; c < 3; ++c) {
+                        dst[c] = static_cast<uint8_t>((src[c] * sa + dst[c] * da + outA / 2) / outA);
+                    }
+                    dst[3] = static_cast<uint8_t>(outA);
+                }
+            }
+        }
+
+        const uint32_t denominator = control.delayDen == 0 ? 100 : control.delayDen;
+        *duration = static_cast<int>((static_cast<uint64_t>(control.delayNum) * 1000 + denominator / 2) / denominator);
+        framesRead += 1;
+        return true;
+    }
+
+private:
+    struct FrameControl {
+        uint32_t width, height, x, y;
+        uint16_t delayNum, delayDen;
+        uint8_t dispose, blend;
+    };
+
+    JxlByteCursor cursor;
+    size_t framesStart = 0;
+    uint8_t bitDepth = 8;
+    uint8_t colorType = 6;
+    uint32_t channels = 4;
+    bool animated = false;
+    bool firstFrameUsesIdat = false;
+    uint32_t numPlays = 0;
+    int framesRead = 0;
+    std::vector<uint8_t> palette;
+    std::vector<uint8_t> transparency;
+    std::vector<uint8_t> compressed;
+    std::vector<uint8_t> raw;
+    std::vector<uint8_t> frame;
+    JxlFrameDisposal disposal;
+
+    /**
+     * Palette, transparency and animation control all precede the first IDAT
+     */
+    void readHeaderChunks() {
+        bool seenFrameControl = false;
+        while (!cursor.atEnd()) {
+            const uint32_t length = cursor.be32();
+            const uint32_t type = cursor.be32();
+            cursor.require(static_cast<size_t>(length) + 4);
+            const uint8_t* payload = cursor.current();
+            if (type == JxlChunkType("PLTE")) {
+                palette.assign(payload, payload + length);
+            } else if (type == JxlChunkType("tRNS")) {
+                transparency.assign(payload, payload + length);
+            } else if (type == JxlChunkType("acTL") && length >= 8) {
+                animated = true;
+                numPlays = (static_cast<uint32_t>(payload[4]) << 24) | (payload[5] << 16) | (payload[6] << 8) | payload[7];
+            } else if (type == JxlChunkType("fcTL")) {
+                seenFrameControl = true;
+            } else if (type == JxlChunkType("IDAT") || type == JxlChunkType("IEND")) {
+                firstFrameUsesIdat = !animated || seenFrameControl;
+                return;
+            }
+            cursor.skip(static_cast<size_t>(length) + 4);
+        }
+    }
+
+    bool findFrameControl(FrameControl& control) {
+        while (!cursor.atEnd()) {
+            const size_t chunkStart = cursor.pos;
+            const uint32_t length = cursor.be32();
+            const uint32_t type = cursor.be32();
+            cursor.require(static_cast<size_t>(length) + 4);
+            const uint8_t* payload = cursor.current();
+
+            if (type == JxlChunkType("IEND")) {
+                return false;
+            }
+            if (type == JxlChunkType("IDAT") && !animated) {
+                if (framesRead > 0) {
+                    return false;
+                }
+                control = {width, height, 0, 0, 0, 100, 0, 0};
+                cursor.pos = chunkStart;
+                return true;
+            }
+            if (type == JxlChunkType("fcTL") && animated && length >= 26) {
+                JxlByteCursor fields(payload + 4, 22);
+                control.width = fields.be32();
+                control.height = fields.be32();
+                control.x = fields.be32();
+                control.y = fields.be32();
+                control.delayNum = fields.be16();
+                control.delayDen = fields.be16();
+                control.dispose = fields.u8();
+                control.blend = fields.u8();
+                cursor.skip(static_cast<size_t>(length) + 4);
+                if (control.width == 0 || control.height == 0
+                    || static_cast<uint64_t>(control.x) + control.width > width
+                    || static_cast<uint64_t>(control.y) + control.height > height) {
+                    ThrowImportError("Invalid APNG frame region");
+                }
+                return true;
+            }
+            // IDAT of a default image that is not part of the animation is skipped as well
+            cursor.skip(static_cast<size_t>(length) + 4);
+        }
+        return false;
+    }
+
+    void collectFrameData() {
+        compressed.clear();
+        while (!cursor.atEnd()) {
+            const size_t chunkStart = cursor.pos;
+            const uint32_t length = cursor.be32();
+            const uint32_t type = cursor.be32();
+            cursor.require(static_cast<size_t>(length) + 4);
+            const uint8_t* payload = cursor.current();
+            if (type == JxlChunkType("fcTL") || type == JxlChunkType("IEND")) {
+                cursor.pos = chunkStart;
+                return;
+            }
+            if (type == JxlChunkType("IDAT") && (framesRead == 0 && firstFrameUsesIdat)) {
+                compressed.insert(compressed.end(), payload, payload + length);
+            } else if (type == JxlChunkType("fdAT") && length >= 4) {
+                compressed.insert(compressed.end(), payload + 4, payload + length);
+            }
+            cursor.skip(static_cast<size_t>(length) + 4);
+        }
+    }
+
+    void inflateFrame(size_t expectedSize) {
+        raw.resize(expectedSize);
+        z_stream stream = {};
+        if (inflateInit(&stream) != Z_OK) {
+            ThrowImportError("Cannot initialize inflate");
+        }
+        stream.next_in = compressed.data();
+        stream.avail_in = static_cast<uInt>(compressed.size());
+        stream.next_out = raw.data();
+        stream.avail_out = static_cast<uInt>(raw.size());
+        const int result = inflate(&stream, Z_FINISH);
+        const size_t produced = raw.size() - stream.avail_out;
+        inflateEnd(&stream);
+        if ((result != Z_STREAM_END && result != Z_BUF_ERROR) || produced != expectedSize) {
+            ThrowImportError("Corrupted PNG image data");
+        }
+    }
+
+    static uint8_t paeth(int a, int b, int c) {
+        const int p = a + b - c;
+        const int pa = std::abs(p - a);
+        const int pb = std::abs(p - b);
+        const int pc = std::abs(p - c);
+        if (pa <= pb && pa <= pc) {
+            return static_cast<uint8_t>(a);
+        }
+        return static_cast<uint8_t>(pb <= pc ? b : c);
+    }
+
+    uint32_t sample(const uint8_t* row, uint32_t index) const {
+        switch (bitDepth) {
+            case 16:
+                return (row[index * 2] << 8) | row[index * 2 + 1];
+            case 8:
+                return row[index];
+            default: {
+                const uint32_t bit = index * bitDepth;
+                const uint32_t shift = 8 - bitDepth - (bit & 7);
+                return (row[bit >> 3] >> shift) & ((1u << bitDepth) - 1);
+            }
+        }
+    }
+
+    uint8_t toByte(uint32_t value) const {
+        if (bitDepth == 16) {
+            return static_cast<uint8_t>(value >> 8);
+        }
+        if (bitDepth == 8) {
+            return static_cast<uint8_t>(value);
+        }
+        return static_cast<uint8_t>(value * 255 / ((1u << bitDepth) - 1));
+    }
+
+    void decodeFrame(const FrameControl& control) {
+        const size_t bitsPerPixel = channels * bitDepth;
+        const size_t rowBytes = (control.width * bitsPerPixel + 7) / 8;
+        const size_t filterStep = std::max(static_cast<size_t>(1), bitsPerPixel / 8);
+        inflateFrame((rowBytes + 1) * control.height);
+
+        std::vector<uint8_t> zeroRow(rowBytes, 0);
+        for (uint32_t y = 0; y < control.height; ++y) {
+            uint8_t* row = raw.data() + y * (rowBytes + 1);
+            const uint8_t filter = row[0];
+            uint8_t* line = row + 1;
+            const uint8_t* previous = y == 0 ? zeroRow.data() : raw.data() + (y - 1) * (rowBytes + 1) + 1;
+            for (size_t i = 0; i < rowBytes; ++i) {
+                const int left = i >= filterStep ? line[i - filterStep] : 0;
+                const int up = previous[i];
+                const int upLeft = i >= filterStep ? previous[i - filterStep] : 0;
+                switch (filter) {
+                    case 0:
+                        break;
+                    case 1:
+                        line[i] = static_cast<uint8_t>(line[i] + left);
+                        break;
+                    case 2:
+                        line[i] = static_cast<uint8_t>(line[i] + up);
+                        break;
+                    case 3:
+                        line[i] = static_cast<uint8_t>(line[i] + ((left + up) >> 1));
+                        break;
+                    case 4:
+                        line[i] = static_cast<uint8_t>(line[i] + paeth(left, up, upLeft));
+                        break;
+                    default:
+                        ThrowImportError("Invalid PNG filter");
+                }
+            }
+        }
+
+        frame.resize(static_cast<size_t>(control.width) * control.height * 4);
+        const size_t paletteEntries = palette.size() / 3;
+        for (uint32_t y = 0; y < control.height; ++y) {
+            const uint8_t* line = raw.data() + y * (rowBytes + 1) + 1;
+            uint8_t* dst = frame.data() + static_cast<size_t>(y) * control.width * 4;
+            for (uint32_t x = 0; x < control.width; ++x, dst += 4) {
+                switch (colorType) {
+                    case 0: {
+                        const uint32_t gray = sample(line, x);
+                        dst[0] = dst[1] = dst[2] = toByte(gray);
+                        dst[3] = transparency.size() >= 2 && gray == static_cast<uint32_t>((transparency[0] << 8) | transparency[1]) ? 0 : 255;
+                        break;
+                    }
+                    case 2: {
+                        const uint32_t r = sample(line, x * 3);
+                        const uint32_t g = sample(line, x * 3 + 1);
+                        const uint32_t b = sample(line, x * 3 + 2);
+                        dst[0] = toByte(r);
+                        dst[1] = toByte(g);
+                        dst[2] = toByte(b);
+                        dst[3] = 255;
+                        if (transparency.size() >= 6
+                            && r == static_cast<uint32_t>((transparency[0] << 8) | transparency[1])
+                            && g == static_cast<uint32_t>((transparency[2] << 8) | transparency[3])
+                            && b == static_cast<uint32_t>((transparency[4] << 8) | transparency[5])) {
+                            dst[3] = 0;
+                        }
+                        break;
+                    }
+                    case 3: {
+                        const uint32_t index = sample(line, x);
+                        if (index < paletteEntries) {
+                            dst[0] = palette[index * 3];
+                            dst[1] = palette[index * 3 + 1];
+                            dst[2] = palette[index * 3 + 2];
+                        } else {
+                            dst[0] = dst[1] = dst[2] = 0;
+                        }
+                        dst[3] = index < transparency.size() ? transparency[index] : 255;
+                        break;
+                    }
+                    case 4:
+                        dst[0] = dst[1] = dst[2] = toByte(sample(line, x * 2));
+                        dst[3] = toByte(sample(line, x * 2 + 1));
+                        break;
+                    case 6:
+                        dst[0] = toByte(sample(line, x * 4));
+                        dst[1] = toByte(sample(line, x * 4 + 1));
+                        dst[2] = toByte(sample(line, x * 4 + 2));
+                        dst[3] = toByte(sample(line, x * 4 + 3));
+                        break;
+                }
+            }
+        }
+    }
+};
+
+// MARK: - Importer
+
+JxlAnimationImporter::JxlAnimationImporter(const uint8_t* data, size_t size) {
+    format = detectFormat(data, size);
+    switch (format) {
+        case importGif:
+            reader = std::make_unique<JxlGifReader>(data, size);
+            break;
+        case importApng:
+            reader = std::make_unique<JxlApngReader>(data, size);
+            break;
+        case importUnknown:
+            ThrowImportError("Only GIF and PNG animations can be imported");
+    }
+    canvas.assign(static_cast<size_t>(reader->width) * reader->height * 4, 0);
+}
+
+JxlAnimationImporter::~JxlAnimationImporter() = default;
+
+JxlImportFormat JxlAnimationImporter::detectFormat(const uint8_t* data, size_t size) {
+    if (size >= 6 && (std::memcmp(data, "GIF87a", 6) == 0 || std::memcmp(data, "GIF89a", 6) == 0)) {
+        return importGif;
+    }
+    static const uint8_t pngSignature[8] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+    if (size >= 8 && std::memcmp(data, pngSignature, 8) == 0) {
+        return importApng;
+    }
+    return importUnknown;
+}
+
+bool JxlAnimationImporter::nextFrame(int* duration) {
+    return reader->nextFrame(canvas, duration);
+}
+
+int JxlAnimationImporter::importInto(JxlAnimatedEncoder& encoder) {
+    if (encoder.getWidth() != static_cast<int>(getWidth()) || encoder.getHeight() != static_cast<int>(getHeight())
+        || encoder.getJxlPixelType() != rgba || encoder.getEncodingPixelFormat() != er8) {
+        ThrowImportError("Encoder must be 8-bit RGBA of the animation size");
+    }
+    int frames = 0;
+    int duration = 0;
+    while (nextFrame(&duration)) {
+        // The encoder keeps its own copy, the canvas carries on into the next frame
+        encoder.addFrame(canvas, duration);
+        frames += 1;
+    }
+    return frames;
+}
+
+uint32_t JxlAnimationImporter::getWidth() {
+    return reader->width;
+}
+
+uint32_t JxlAnimationImporter::getHeight() {
+    return reader->height;
+}
+
+int JxlAnimationImporter::getLoopCount() {
+    return reader->loopCount;
+}
@@ -0,0 +1,105 @@
+//
+//  JxlAnimationImporter.hpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#ifndef JxlAnimationImporter_hpp
+#define JxlAnimationImporter_hpp
+
+#ifdef __cplusplus
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <memory>
+#include "JxlAnimatedEncoder.hpp"
+
+class AnimationImportError : public std::exception {
+public:
+    AnimationImportError(const std::string& message) : errorMessage(message) {}
+
+    const char* what() const noexcept override {
+        return errorMessage.c_str();
+    }
+
+private:
+    std::string errorMessage;
+};
+
+enum JxlImportFormat {
+    importUnknown = 0,
+    importGif = 1,
+    importApng = 2
+};
+
+class JxlAnimationReader;
+
+/**
+ * Reads GIF and APNG (or plain PNG) animations frame by frame.
+ * Frames are composited into a single RGBA8 canvas following the disposal and blend rules of the source,
+ * only the region a "restore previous" disposal needs is kept besides it.
+ */
+class JxlAnimationImporter {
+public:
+    /**
+     * @param data borrowed, e.g. a memory mapped file, must outlive the importer
+     */
+    JxlAnimationImporter(const uint8_t* data, size_t size);
+    ~JxlAnimationImporter();
+
+    static JxlImportFormat detectFormat(const uint8_t* data, size_t size);
+
+    /**
+     * Composites the next frame into the canvas
+     * @param duration display time of the frame in milliseconds
+     * @return false when there are no more frames
+     */
+    bool nextFrame(int* duration);
+
+    /**
+     * Encodes every remaining frame, the encoder must be RGBA, 8-bit and of the source size
+     * @return count of imported frames
+     */
+    int importInto(JxlAnimatedEncoder& encoder);
+
+    const std::vector<uint8_t>& getCanvas() {
+        return canvas;
+    }
+
+    uint32_t getWidth();
+    uint32_t getHeight();
+    /// 0 means infinite, as in JxlAnimatedEncoder
+    int getLoopCount();
+    JxlImportFormat getFormat() {
+        return format;
+    }
+
+private:
+    JxlImportFormat format;
+    std::unique_ptr<JxlAnimationReader> reader;
+    std::vector<uint8_t> canvas;
+};
+
+#endif
+
+#endif /* JxlAnimationImporter_hpp */
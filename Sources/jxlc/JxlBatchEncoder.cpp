@@ -0,0 +1,152 @@
+//
+//  JxlBatchEncoder.cpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#include "JxlBatchEncoder.hpp"
+#include "JxlWorker.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+
+namespace jxlcoder {
+
+// libjxl splits frames into 256x256 groups, fewer than four of them per thread do not pay off
+static constexpr uint64_t kBatchPixelsPerThread = 512 * 512;
+
+JxlBatchEncoder::JxlBatchEncoder(int coreBudget) {
+    if (coreBudget <= 0) {
+        coreBudget = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    this->coreBudget = std::max(coreBudget, 1);
+}
+
+int JxlBatchEncoder::threadsForJob(uint64_t pixels, size_t pendingJobs, int coreBudget, int freeCores) {
+    const uint64_t wanted = (pixels + kBatchPixelsPerThread - 1) / kBatchPixelsPerThread;
+    int threads = static_cast<int>(std::clamp<uint64_t>(wanted, 1, static_cast<uint64_t>(coreBudget)));
+    // While the queue is deep the cores are shared evenly between the waiting jobs,
+    // when it drains the last large images take whatever became free
+    const size_t sharers = std::clamp<size_t>(pendingJobs, 1, static_cast<size_t>(coreBudget));
+    threads = std::min(threads, std::max(coreBudget / static_cast<int>(sharers), 1));
+    return std::clamp(threads, 1, std::max(freeCores, 1));
+}
+
+std::vector<JxlBatchJobResult> JxlBatchEncoder::encode(const std::vector<JxlBatchJob> &jobs,
+                                                       JxlBatchStatistics *statistics) {
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<JxlBatchJobResult> results(jobs.size());
+    std::atomic<size_t> nextJob(0);
+
+    std::mutex lock;
+    std::condition_variable coresReleased;
+    int freeCores = coreBudget;
+
+    const auto submitted = Clock::now();
+
+    // A fixed pool pulls jobs in order, every job still waits until its share of the cores is free
+    auto work = [&]() {
+        for (;;) {
+            const size_t i = nextJob.fetch_add(1);
+            if (i >= jobs.size()) {
+                return;
+            }
+            const JxlBatchJob &job = jobs[i];
+            int threads;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                coresReleased.wait(guard, [&] { return freeCores > 0; });
+                threads = threadsForJob(static_cast<uint64_t>(job.xsize) * job.ysize,
+                                        jobs.size() - i, coreBudget, freeCores);
+                freeCores -= threads;
+            }
+
+            JxlBatchJobResult &result = results[i];
+            result.threads = threads;
+            const auto start = Clock::now();
+            try {
+                result.succeed = EncodeJxlOneshot(job.pixels, job.xsize, job.ysize,
+                                                  &result.compressed, job.colorspace,
+                                                  job.compressionOption, job.distance,
+                                                  job.effort, job.decodingSpeed,
+                                                  threads, job.options, job.metadata);
+            } catch (std::bad_alloc &err) {
+                result.succeed = false;
+            }
+            if (!result.succeed) {
+                result.compressed.clear();
+            }
+            const auto finish = Clock::now();
+            result.encodeTime = std::chrono::duration<double, std::milli>(finish - start).count();
+            result.latency = std::chrono::duration<double, std::milli>(finish - submitted).count();
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                freeCores += threads;
+            }
+            coresReleased.notify_all();
+        }
+    };
+
+    const size_t poolSize = std::min(static_cast<size_t>(coreBudget), jobs.size());
+    std::vector<std::thread> workers;
+    workers.reserve(poolSize);
+    for (size_t i = 0; i < poolSize; ++i) {
+        workers.emplace_back(work);
+    }
+    for (auto &worker: workers) {
+        worker.join();
+    }
+
+    if (statistics) {
+        const double wallTime = std::chrono::duration<double, std::milli>(Clock::now() - submitted).count();
+        JxlBatchStatistics stats;
+        stats.jobs = jobs.size();
+        stats.wallTime = wallTime;
+        double pixels = 0;
+        double latencySum = 0;
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            if (!results[i].succeed) {
+                stats.failedJobs += 1;
+            }
+            pixels += static_cast<double>(jobs[i].xsize) * static_cast<double>(jobs[i].ysize);
+            latencySum += results[i].latency;
+            stats.maxLatency = std::max(stats.maxLatency, results[i].latency);
+        }
+        if (!jobs.empty()) {
+            stats.meanLatency = latencySum / static_cast<double>(jobs.size());
+        }
+        if (wallTime > 0) {
+            stats.imagesPerSecond = static_cast<double>(jobs.size()) * 1000.0 / wallTime;
+            stats.megapixelsPerSecond = pixels / 1e6 * 1000.0 / wallTime;
+        }
+        *statistics = stats;
+    }
+
+    return results;
+}
+
+}
@@ -0,0 +1,109 @@
+//
+//  JxlBatchEncoder.hpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#pragma once
+
+#ifdef __cplusplus
+
+#include <cstdint>
+#include <vector>
+#include "JxlDefinitions.h"
+#include "JxlEncoderOptions.hpp"
+#include "JxlEncoderMetadata.hpp"
+
+namespace jxlcoder {
+
+struct JxlBatchJob {
+    /// Interleaved 8-bit pixels in the layout of colorspace
+    std::vector<uint8_t> pixels;
+    uint32_t xsize;
+    uint32_t ysize;
+    JxlPixelType colorspace;
+    JxlCompressionOption compressionOption;
+    float distance;
+    int effort;
+    int decodingSpeed;
+    JxlEncoderOptions options;
+    /// Borrowed payloads, must outlive the batch
+    JxlEncoderMetadata metadata;
+};
+
+struct JxlBatchJobResult {
+    bool succeed = false;
+    std::vector<uint8_t> compressed;
+    /// Threads libjxl was given for this job
+    int threads = 0;
+    /// Time from the batch submission until the job has finished, in milliseconds
+    double latency = 0;
+    /// Time the encoder itself spent on the job, in milliseconds
+    double encodeTime = 0;
+};
+
+struct JxlBatchStatistics {
+    size_t jobs = 0;
+    size_t failedJobs = 0;
+    /// Wall time of the whole batch, in milliseconds
+    double wallTime = 0;
+    double imagesPerSecond = 0;
+    double megapixelsPerSecond = 0;
+    double meanLatency = 0;
+    double maxLatency = 0;
+};
+
+/**
+ * Encodes a queue of images within a fixed core budget.
+ * Small images are encoded on a single thread each with many in flight, large ones are given
+ * several libjxl workers, so N images never spawn N times the core count of threads.
+ */
+class JxlBatchEncoder {
+public:
+    /**
+     * @param coreBudget threads the batch may occupy, 0 means one per core
+     */
+    explicit JxlBatchEncoder(int coreBudget = 0);
+
+    /**
+     * Encodes every job, results are in the order of jobs
+     * @param statistics optional aggregate throughput and latency of the batch
+     */
+    std::vector<JxlBatchJobResult> encode(const std::vector<JxlBatchJob> &jobs,
+                                          JxlBatchStatistics *statistics = nullptr);
+
+    int getCoreBudget() const {
+        return coreBudget;
+    }
+
+    /**
+     * @return libjxl threads for an image, given the jobs still waiting in the queue and the free cores
+     */
+    static int threadsForJob(uint64_t pixels, size_t pendingJobs, int coreBudget, int freeCores);
+
+private:
+    int coreBudget;
+};
+
+}
+
+#endif
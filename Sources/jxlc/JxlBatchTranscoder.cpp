@@ -0,0 +1,308 @@
+//
+//  JxlBatchTranscoder.cpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#include "JxlBatchTranscoder.hpp"
+#include "JxlTranscode.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace jxlcoder {
+
+// Encoded bytes are handed to the file in chunks of this size
+static constexpr size_t kTranscodeOutputChunk = 1024 * 256;
+
+/**
+ * Read-only view of a whole file, mapped so libjxl reads the JPEG without an intermediate copy
+ */
+class JxlMappedFile {
+public:
+    explicit JxlMappedFile(const std::string &path) {
+        fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            error = std::strerror(errno);
+            return;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            error = std::strerror(errno);
+            return;
+        }
+        size = static_cast<size_t>(info.st_size);
+        if (size == 0) {
+            error = "File is empty";
+            return;
+        }
+        void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            error = std::strerror(errno);
+            return;
+        }
+        madvise(mapped, size, MADV_SEQUENTIAL);
+        data = reinterpret_cast<const uint8_t *>(mapped);
+    }
+
+    ~JxlMappedFile() {
+        if (data) {
+            munmap(const_cast<uint8_t *>(data), size);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    JxlMappedFile(const JxlMappedFile &) = delete;
+    JxlMappedFile &operator=(const JxlMappedFile &) = delete;
+
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+    std::string error;
+
+private:
+    int fd = -1;
+};
+
+/**
+ * Output processor writing into a file descriptor, the chunk is reused for every file of a worker
+ */
+struct JxlFileOutput {
+    int fd = -1;
+    std::vector<uint8_t> chunk;
+    uint64_t position = 0;
+    uint64_t written = 0;
+    bool failed = false;
+
+    static void *getBuffer(void *opaque, size_t *size) {
+        auto output = reinterpret_cast<JxlFileOutput *>(opaque);
+        if (output->failed) {
+            *size = 0;
+            return nullptr;
+        }
+        *size = std::min(*size == 0 ? output->chunk.size() : *size, output->chunk.size());
+        return output->chunk.data();
+    }
+
+    static void releaseBuffer(void *opaque, size_t writtenBytes) {
+        auto output = reinterpret_cast<JxlFileOutput *>(opaque);
+        size_t offset = 0;
+        while (!output->failed && offset < writtenBytes) {
+            const ssize_t result = pwrite(output->fd, output->chunk.data() + offset, writtenBytes - offset,
+                                          static_cast<off_t>(output->position + offset));
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            if (result <= 0) {
+                output->failed = true;
+                return;
+            }
+            offset += static_cast<size_t>(result);
+        }
+        output->position += writtenBytes;
+        output->written = std::max(output->written, output->position);
+    }
+
+    static void seek(void *opaque, uint64_t position) {
+        reinterpret_cast<JxlFileOutput *>(opaque)->position = position;
+    }
+
+    static void setFinalizedPosition(void *, uint64_t) {
+        // pwrite lands on disk directly, nothing is held back
+    }
+
+    JxlEncoderOutputProcessor processor() {
+        return {
+            .opaque = this,
+            .get_buffer = &JxlFileOutput::getBuffer,
+            .release_buffer = &JxlFileOutput::releaseBuffer,
+            .seek = &JxlFileOutput::seek,
+            .set_finalized_position = &JxlFileOutput::setFinalizedPosition,
+        };
+    }
+};
+
+static void transcodeFile(JxlJpegTranscoder &transcoder, JxlFileOutput &output,
+                          const JxlTranscodeTask &task, size_t index, int effort, int decodingSpeed,
+                          const JxlEncoderOptions &options, JxlTranscodeFileResult &result) {
+    JxlMappedFile input(task.inputPath);
+    if (!input.data) {
+        result.error = "Cannot read " + task.inputPath + ": " + input.error;
+        return;
+    }
+    result.inputSize = input.size;
+
+    // The task index keeps partial files of concurrent workers apart
+    const std::string partialPath = task.outputPath + "." + std::to_string(index) + ".partial";
+    output.fd = open(partialPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (output.fd < 0) {
+        result.error = "Cannot create " + partialPath + ": " + std::strerror(errno);
+        return;
+    }
+    output.position = 0;
+    output.written = 0;
+    output.failed = false;
+
+    const bool encoded = transcoder.transcode(input.data, input.size, output.processor(),
+                                              effort, decodingSpeed, options);
+    const bool closed = close(output.fd) == 0;
+    output.fd = -1;
+
+    if (!encoded || output.failed || !closed) {
+        result.error = output.failed || !closed ? "Cannot write " + partialPath
+                                                : "Cannot transcode provided 'JPEG' data into JXL";
+        unlink(partialPath.c_str());
+        return;
+    }
+    if (std::rename(partialPath.c_str(), task.outputPath.c_str()) != 0) {
+        result.error = "Cannot move output to " + task.outputPath + ": " + std::strerror(errno);
+        unlink(partialPath.c_str());
+        return;
+    }
+    result.outputSize = output.written;
+    result.succeed = true;
+}
+
+JxlBatchTranscoder::JxlBatchTranscoder(int workers, int threadsPerWorker) {
+    if (workers <= 0) {
+        workers = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    this->workers = std::max(workers, 1);
+    this->threadsPerWorker = std::max(threadsPerWorker, 1);
+}
+
+std::vector<JxlTranscodeFileResult> JxlBatchTranscoder::transcode(const std::vector<JxlTranscodeTask> &tasks,
+                                                                  int effort, int decodingSpeed,
+                                                                  const JxlEncoderOptions &options,
+                                                                  JxlTranscodeStatistics *statistics,
+                                                                  const Progress &progress) {
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<JxlTranscodeFileResult> results(tasks.size());
+    std::atomic<size_t> nextTask(0);
+    std::mutex progressLock;
+
+    const auto submitted = Clock::now();
+
+    // Two tasks writing one file would race on it and both report success, later ones are rejected.
+    // Paths are compared case-insensitively since the default Apple file systems are
+    std::unordered_map<std::string, size_t> outputOwners;
+    outputOwners.reserve(tasks.size());
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        std::string key = std::filesystem::path(tasks[i].outputPath).lexically_normal().string();
+        std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) {
+            return static_cast<char>(std::tolower(c));
+        });
+        auto owner = outputOwners.emplace(std::move(key), i);
+        if (!owner.second) {
+            results[i].error = "Output " + tasks[i].outputPath + " is also the output of "
+                               + tasks[owner.first->second].inputPath;
+        }
+    }
+
+    auto work = [&]() {
+        std::unique_ptr<JxlJpegTranscoder> transcoder;
+        JxlFileOutput output;
+        try {
+            transcoder = std::make_unique<JxlJpegTranscoder>(threadsPerWorker);
+            output.chunk.resize(kTranscodeOutputChunk);
+        } catch (std::bad_alloc &err) {
+            transcoder.reset();
+        }
+        for (;;) {
+            const size_t index = nextTask.fetch_add(1);
+            if (index >= tasks.size()) {
+                return;
+            }
+            JxlTranscodeFileResult &result = results[index];
+            const auto start = Clock::now();
+            // Tasks rejected before the batch started already carry their error
+            const bool rejected = !result.error.empty();
+            if (rejected) {
+                result.succeed = false;
+            } else if (!transcoder) {
+                result.error = "Cannot initialize encoder";
+            } else {
+                try {
+                    transcodeFile(*transcoder, output, tasks[index], index, effort, decodingSpeed, options, result);
+                } catch (std::bad_alloc &err) {
+                    result.succeed = false;
+                    result.error = "Not enough memory to transcode " + tasks[index].inputPath;
+                }
+            }
+            result.time = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            if (progress) {
+                std::lock_guard<std::mutex> guard(progressLock);
+                progress(index, result);
+            }
+        }
+    };
+
+    const size_t poolSize = std::min(static_cast<size_t>(workers), tasks.size());
+    std::vector<std::thread> pool;
+    pool.reserve(poolSize);
+    for (size_t i = 0; i < poolSize; ++i) {
+        pool.emplace_back(work);
+    }
+    for (auto &worker: pool) {
+        worker.join();
+    }
+
+    if (statistics) {
+        JxlTranscodeStatistics stats;
+        stats.files = tasks.size();
+        stats.wallTime = std::chrono::duration<double, std::milli>(Clock::now() - submitted).count();
+        for (const auto &result: results) {
+            if (!result.succeed) {
+                stats.failedFiles += 1;
+                continue;
+            }
+            stats.inputBytes += result.inputSize;
+            stats.outputBytes += result.outputSize;
+        }
+        if (stats.wallTime > 0) {
+            const double seconds = stats.wallTime / 1000.0;
+            stats.filesPerSecond = static_cast<double>(stats.files - stats.failedFiles) / seconds;
+            stats.megabytesPerSecond = static_cast<double>(stats.inputBytes) / (1024.0 * 1024.0) / seconds;
+        }
+        *statistics = stats;
+    }
+
+    return results;
+}
+
+}
@@ -0,0 +1,112 @@
+//
+//  JxlBatchTranscoder.hpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#pragma once
+
+#ifdef __cplusplus
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "JxlEncoderOptions.hpp"
+
+namespace jxlcoder {
+
+struct JxlTranscodeTask {
+    std::string inputPath;
+    std::string outputPath;
+};
+
+struct JxlTranscodeFileResult {
+    bool succeed = false;
+    uint64_t inputSize = 0;
+    uint64_t outputSize = 0;
+    /// Time spent on the file including I/O, in milliseconds
+    double time = 0;
+    /// Reason of the failure, empty on success
+    std::string error;
+
+    /// Fraction of the JPEG size saved, 0.2 means the JXL is 20% smaller
+    double savings() const {
+        return inputSize > 0 ? 1.0 - static_cast<double>(outputSize) / static_cast<double>(inputSize) : 0;
+    }
+};
+
+struct JxlTranscodeStatistics {
+    size_t files = 0;
+    size_t failedFiles = 0;
+    /// Sizes of the successfully transcoded files only
+    uint64_t inputBytes = 0;
+    uint64_t outputBytes = 0;
+    /// Wall time of the whole batch, in milliseconds
+    double wallTime = 0;
+    double filesPerSecond = 0;
+    /// JPEG megabytes consumed per second
+    double megabytesPerSecond = 0;
+};
+
+/**
+ * Losslessly recompresses JPEG files into JXL on a pool of workers.
+ * Every worker keeps its own encoder for the whole batch, inputs are memory mapped
+ * and outputs are written to disk while they are encoded
+ */
+class JxlBatchTranscoder {
+public:
+    /**
+     * Called once per finished file, calls are serialized but come from the workers
+     */
+    using Progress = std::function<void(size_t index, const JxlTranscodeFileResult &result)>;
+
+    /**
+     * @param workers files transcoded concurrently, 0 means one per core
+     * @param threadsPerWorker libjxl threads of every worker, 1 suits many small files best
+     */
+    explicit JxlBatchTranscoder(int workers = 0, int threadsPerWorker = 1);
+
+    /**
+     * Outputs are written next to their destination and renamed once complete,
+     * so an interrupted batch never leaves a truncated JXL behind.
+     * A task whose output path repeats an earlier one, compared case-insensitively, fails without being transcoded
+     * @return results in the order of tasks
+     */
+    std::vector<JxlTranscodeFileResult> transcode(const std::vector<JxlTranscodeTask> &tasks,
+                                                  int effort, int decodingSpeed = 3,
+                                                  const JxlEncoderOptions &options = JxlEncoderOptions(),
+                                                  JxlTranscodeStatistics *statistics = nullptr,
+                                                  const Progress &progress = nullptr);
+
+    int getWorkers() const {
+        return workers;
+    }
+
+private:
+    int workers;
+    int threadsPerWorker;
+};
+
+}
+
+#endif
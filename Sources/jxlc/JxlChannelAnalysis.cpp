@@ -0,0 +1,173 @@
+//
+//  JxlChannelAnalysis.cpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#include "JxlChannelAnalysis.hpp"
+#include "concurrency.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+#include <hwy/foreach_target.h>  // IWYU pragma: keep
+#include <hwy/highway.h>
+#include "hwy/base.h"
+
+namespace jxlcoder {
+
+using namespace hwy;
+using namespace hwy::HWY_NAMESPACE;
+
+static int JxlAnalysisThreadsCount(uint32_t width, uint32_t height) {
+    // Below ~256x256 spawning threads costs more than the scan itself
+    const int suggested = static_cast<int>((static_cast<uint64_t>(width) * height) / (256 * 256));
+    const int hardware = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+    return std::clamp(suggested, 1, std::min(hardware, static_cast<int>(std::max(height, 1u))));
+}
+
+static void AnalyzeRGBARow(const uint8_t *__restrict__ src, const uint32_t width,
+                           bool &opaque, bool &grayscale) {
+    const ScalableTag<uint8_t> du;
+    using V = Vec<decltype(du)>;
+    const uint32_t pixels = static_cast<uint32_t>(Lanes(du));
+    const V maxAlpha = Set(du, 255);
+
+    uint32_t x = 0;
+
+    for (; x + pixels <= width && (opaque || grayscale); x += pixels) {
+        V r, g, b, a;
+        LoadInterleaved4(du, src, r, g, b, a);
+        if (opaque && !AllTrue(du, Eq(a, maxAlpha))) {
+            opaque = false;
+        }
+        if (grayscale && !AllTrue(du, And(Eq(r, g), Eq(g, b)))) {
+            grayscale = false;
+        }
+        src += 4 * pixels;
+    }
+
+    for (; x < width && (opaque || grayscale); ++x) {
+        if (src[3] != 255) {
+            opaque = false;
+        }
+        if (src[0] != src[1] || src[1] != src[2]) {
+            grayscale = false;
+        }
+        src += 4;
+    }
+}
+
+static void ReduceRGBARow(const uint8_t *__restrict__ src, uint8_t *__restrict__ dst,
+                          const uint32_t width, const JxlPixelType pixelType) {
+    if (pixelType == rgba) {
+        std::copy(src, src + width * 4, dst);
+        return;
+    }
+
+    const ScalableTag<uint8_t> du;
+    using V = Vec<decltype(du)>;
+    const uint32_t pixels = static_cast<uint32_t>(Lanes(du));
+    const int components = JxlPixelTypeChannels(pixelType);
+
+    uint32_t x = 0;
+
+    for (; x + pixels <= width; x += pixels) {
+        V r, g, b, a;
+        LoadInterleaved4(du, src, r, g, b, a);
+        switch (pixelType) {
+            case gray:
+                StoreU(r, du, dst);
+                break;
+            case grayAlpha:
+                StoreInterleaved2(r, a, du, dst);
+                break;
+            case rgb:
+                StoreInterleaved3(r, g, b, du, dst);
+                break;
+            case rgba:
+                break;
+        }
+        src += 4 * pixels;
+        dst += components * pixels;
+    }
+
+    for (; x < width; ++x) {
+        switch (pixelType) {
+            case gray:
+                dst[0] = src[0];
+                break;
+            case grayAlpha:
+                dst[0] = src[0];
+                dst[1] = src[3];
+                break;
+            case rgb:
+                dst[0] = src[0];
+                dst[1] = src[1];
+                dst[2] = src[2];
+                break;
+            case rgba:
+                break;
+        }
+        src += 4;
+        dst += components;
+    }
+}
+
+JxlPixelType AnalyzeRGBAChannels(const uint8_t *src, uint32_t stride, uint32_t width, uint32_t height) {
+    std::atomic<bool> opaque(true);
+    std::atomic<bool> grayscale(true);
+
+    concurrency::parallel_for(JxlAnalysisThreadsCount(width, height), height, [&](int y) {
+        bool rowOpaque = opaque.load(std::memory_order_relaxed);
+        bool rowGrayscale = grayscale.load(std::memory_order_relaxed);
+        if (!rowOpaque && !rowGrayscale) {
+            return;
+        }
+        AnalyzeRGBARow(src + static_cast<size_t>(y) * stride, width, rowOpaque, rowGrayscale);
+        if (!rowOpaque) {
+            opaque.store(false, std::memory_order_relaxed);
+        }
+        if (!rowGrayscale) {
+            grayscale.store(false, std::memory_order_relaxed);
+        }
+    });
+
+    if (grayscale) {
+        return opaque ? gray : grayAlpha;
+    }
+    return opaque ? rgb : rgba;
+}
+
+void ReduceRGBAChannels(const uint8_t *src, uint32_t stride, uint32_t width, uint32_t height,
+                        JxlPixelType pixelType, std::vector<uint8_t> &dst) {
+    const int components = JxlPixelTypeChannels(pixelType);
+    const size_t newStride = static_cast<size_t>(width) * components;
+    dst.resize(newStride * height);
+
+    concurrency::parallel_for(JxlAnalysisThreadsCount(width, height), height, [&](int y) {
+        ReduceRGBARow(src + static_cast<size_t>(y) * stride, dst.data() + newStride * y, width, pixelType);
+    });
+}
+
+}
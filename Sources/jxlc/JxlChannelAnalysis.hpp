@@ -0,0 +1,80 @@
+//
+//  JxlChannelAnalysis.hpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#pragma once
+
+#ifdef __cplusplus
+
+#include <cstdint>
+#include <vector>
+#include "JxlDefinitions.h"
+
+namespace jxlcoder {
+
+/**
+ * Scans 8-bit RGBA pixels and finds the smallest layout that represents them without loss.
+ * Alpha is dropped when every pixel is opaque, colour is collapsed to one channel when R == G == B everywhere.
+ *
+ * @param src source pixels
+ * @param stride source row stride in bytes
+ * @param width width of the image
+ * @param height height of the image
+ * @return one of gray, grayAlpha, rgb or rgba
+ */
+JxlPixelType AnalyzeRGBAChannels(const uint8_t *src, uint32_t stride, uint32_t width, uint32_t height);
+
+/**
+ * Repacks 8-bit RGBA pixels into the tightly packed layout of the requested pixel type.
+ *
+ * @param src source pixels
+ * @param stride source row stride in bytes
+ * @param width width of the image
+ * @param height height of the image
+ * @param pixelType target layout, usually obtained from AnalyzeRGBAChannels
+ * @param dst will be resized and populated with `width * height * channels` bytes
+ */
+void ReduceRGBAChannels(const uint8_t *src, uint32_t stride, uint32_t width, uint32_t height,
+                        JxlPixelType pixelType, std::vector<uint8_t> &dst);
+
+/**
+ * @return count of interleaved channels for the pixel type
+ */
+static inline int JxlPixelTypeChannels(JxlPixelType pixelType) {
+    switch (pixelType) {
+        case gray:
+            return 1;
+        case grayAlpha:
+            return 2;
+        case rgb:
+            return 3;
+        case rgba:
+            return 4;
+    }
+    return 4;
+}
+
+}
+
+#endif
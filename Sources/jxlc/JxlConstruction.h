@@ -8,9 +8,36 @@
 #pragma once
 
 #import <Foundation/Foundation.h>
+#import "JXLEncoderOptions.h"
+
+@interface JXLTranscodeFileReport : NSObject
+@property (nonatomic, readonly) BOOL succeed;
+@property (nonatomic, readonly) uint64_t inputSize;
+@property (nonatomic, readonly) uint64_t outputSize;
+/// Seconds spent on the file including I/O
+@property (nonatomic, readonly) double time;
+@property (nonatomic, readonly, strong, nullable) NSString *errorMessage;
+@end
 
 @interface JxlConstruction : NSObject
-+(nullable NSData*)transcode:(nonnull NSData*)data error:(NSError * _Nullable *_Nullable)error;
++(nullable NSData*)transcode:(nonnull NSData*)data options:(nullable JXLEncoderOptions*)options error:(NSError * _Nullable *_Nullable)error;
++(nullable NSData*)transcode:(nonnull NSData*)data effort:(int)effort options:(nullable JXLEncoderOptions*)options error:(NSError * _Nullable *_Nullable)error;
+/**
+ * Transcodes JPEG files into JXL files on a pool of workers that reuse their encoders, failed files don't stop the batch
+ * @param workers files transcoded concurrently, 0 means one per core
+ * @param progress called once per finished file from the workers, calls never overlap
+ * @return reports in the order of inputs
+ */
++(nullable NSArray<JXLTranscodeFileReport*>*)transcodeFiles:(nonnull NSArray<NSString*>*)inputs
+                                                    outputs:(nonnull NSArray<NSString*>*)outputs
+                                                     effort:(int)effort
+                                                    workers:(int)workers
+                                                    options:(nullable JXLEncoderOptions*)options
+                                                   progress:(nullable void (^)(NSInteger index, JXLTranscodeFileReport * _Nonnull report))progress
+                                                   wallTime:(nonnull double*)wallTime
+                                             filesPerSecond:(nonnull double*)filesPerSecond
+                                         megabytesPerSecond:(nonnull double*)megabytesPerSecond
+                                                      error:(NSError * _Nullable *_Nullable)error;
 +(nullable NSData*)inverse:(nonnull NSData*)data error:(NSError * _Nullable *_Nullable)error;
 
 @end
@@ -9,6 +9,7 @@
 #import "JxlConstruction.h"
 #import "JxlTranscode.hpp"
 #import "JxlJpegInverse.hpp"
+#import "JxlBatchTranscoder.hpp"
 
 template <typename DataType>
 class JxlConstructionDataWrapper {
@@ -17,16 +18,44 @@ public:
     std::vector<DataType> data;
 };
 
+@interface JXLTranscodeFileReport ()
+-(nonnull instancetype)initWithResult:(const jxlcoder::JxlTranscodeFileResult&)result;
+@end
+
+@implementation JXLTranscodeFileReport
+
+-(nonnull instancetype)initWithResult:(const jxlcoder::JxlTranscodeFileResult&)result {
+    self = [super init];
+    if (self) {
+        _succeed = result.succeed;
+        _inputSize = result.inputSize;
+        _outputSize = result.outputSize;
+        _time = result.time / 1000.0;
+        _errorMessage = result.error.empty() ? nil : [NSString stringWithUTF8String:result.error.c_str()];
+    }
+    return self;
+}
+
+@end
+
 @implementation JxlConstruction {
     
 }
 
-+(nullable NSData*)transcode:(nonnull NSData*)data error:(NSError * _Nullable *_Nullable)error {
++(nullable NSData*)transcode:(nonnull NSData*)data options:(nullable JXLEncoderOptions*)options error:(NSError * _Nullable *_Nullable)error {
+    return [self transcode:data effort:7 options:options error:error];
+}
+
++(nullable NSData*)transcode:(nonnull NSData*)data effort:(int)effort options:(nullable JXLEncoderOptions*)options error:(NSError * _Nullable *_Nullable)error {
+    if (effort < 1 || effort > 9) {
+        *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Effort must be clamped in 1...9" }];
+        return nullptr;
+    }
     try {
         std::vector<uint8_t> source([data length]);
         auto srcBytes = reinterpret_cast<const uint8_t*>([data bytes]);
         std::copy(srcBytes, srcBytes + [data length], source.begin());
-        jxlcoder::JxlConstruction contruction(source);
+        jxlcoder::JxlConstruction contruction(source, options ? [options jxlOptions] : jxlcoder::JxlEncoderOptions(), effort);
         if (!contruction.construct()) {
             *error = [[NSError alloc] initWithDomain:@"JXLCoder"
                                                 code:500
@@ -51,6 +80,62 @@ public:
     }
 }
 
++(nullable NSArray<JXLTranscodeFileReport*>*)transcodeFiles:(nonnull NSArray<NSString*>*)inputs
+                                                    outputs:(nonnull NSArray<NSString*>*)outputs
+                                                     effort:(int)effort
+                                                    workers:(int)workers
+                                                    options:(nullable JXLEncoderOptions*)options
+                                                   progress:(nullable void (^)(NSInteger index, JXLTranscodeFileReport * _Nonnull report))progress
+                                                   wallTime:(nonnull double*)wallTime
+                                             filesPerSecond:(nonnull double*)filesPerSecond
+                                         megabytesPerSecond:(nonnull double*)megabytesPerSecond
+                                                      error:(NSError * _Nullable *_Nullable)error {
+    if (inputs.count != outputs.count) {
+        *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Every input must have an output path" }];
+        return nil;
+    }
+    if (effort < 1 || effort > 9) {
+        *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Effort must be clamped in 1...9" }];
+        return nil;
+    }
+    try {
+        std::vector<jxlcoder::JxlTranscodeTask> tasks(inputs.count);
+        for (NSUInteger i = 0; i < inputs.count; ++i) {
+            tasks[i].inputPath = std::string([inputs[i] fileSystemRepresentation]);
+            tasks[i].outputPath = std::string([outputs[i] fileSystemRepresentation]);
+        }
+
+        jxlcoder::JxlBatchTranscoder::Progress onProgress = nullptr;
+        if (progress) {
+            onProgress = [progress](size_t index, const jxlcoder::JxlTranscodeFileResult &result) {
+                @autoreleasepool {
+                    progress((NSInteger)index, [[JXLTranscodeFileReport alloc] initWithResult:result]);
+                }
+            };
+        }
+
+        jxlcoder::JxlBatchTranscoder transcoder(workers);
+        jxlcoder::JxlTranscodeStatistics statistics;
+        auto results = transcoder.transcode(tasks, effort, 3,
+                                            options ? [options jxlOptions] : jxlcoder::JxlEncoderOptions(),
+                                            &statistics, onProgress);
+
+        NSMutableArray<JXLTranscodeFileReport*> *reports = [[NSMutableArray alloc] initWithCapacity:results.size()];
+        for (const auto &result: results) {
+            [reports addObject:[[JXLTranscodeFileReport alloc] initWithResult:result]];
+        }
+        *wallTime = statistics.wallTime / 1000.0;
+        *filesPerSecond = statistics.filesPerSecond;
+        *megabytesPerSecond = statistics.megabytesPerSecond;
+        return reports;
+    } catch (std::bad_alloc &err) {
+        *error = [[NSError alloc] initWithDomain:@"JXLCoder"
+                                            code:500
+                                        userInfo:@{ NSLocalizedDescriptionKey: [NSString stringWithFormat:@"Transcoding files error: %s", err.what()] }];
+        return nil;
+    }
+}
+
 +(nullable NSData*)inverse:(nonnull NSData*)data error:(NSError * _Nullable *_Nullable)error {
     try {
         std::vector<uint8_t> source([data length]);
@@ -28,7 +28,9 @@
 
 enum JxlPixelType {
     rgb = 1,
-    rgba = 2
+    rgba = 2,
+    gray = 3,
+    grayAlpha = 4
 };
 
 enum JxlCompressionOption {
@@ -39,12 +41,30 @@ enum JxlCompressionOption {
 enum JxlDecodingPixelFormat {
     optimal = 1,
     r8 = 2,
-    float16 = 3
+    float16 = 3,
+    r16 = 4,
+    float32 = 5
 };
 
 enum JxlEncodingPixelFormat {
     er8 = 1,
-    efloat16 = 2
+    efloat16 = 2,
+    er16 = 3,
+    efloat32 = 4
+};
+
+/**
+ * Transfer function the encoded samples are tagged with
+ */
+enum JxlEncodingTransfer {
+    /// sRGB for integer samples, linear for float samples
+    etAutomatic = 1,
+    etSRGB = 2,
+    etLinear = 3,
+    /// SMPTE ST 2084 with BT.2100 primaries
+    etPQ = 4,
+    /// Hybrid log-gamma with BT.2100 primaries
+    etHLG = 5
 };
 
 enum JxlExposedOrientation {
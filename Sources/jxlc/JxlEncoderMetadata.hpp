@@ -0,0 +1,131 @@
+//
+//  JxlEncoderMetadata.hpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#pragma once
+
+#ifdef __cplusplus
+
+#include <jxl/encode.h>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+namespace jxlcoder {
+
+/**
+ * Color profile and metadata boxes written by the encoders.
+ * All payloads are borrowed and must outlive the encode call, libjxl copies them internally.
+ */
+struct JxlEncoderMetadata {
+    /// ICC profile describing the pixels, when empty the image is tagged as sRGB
+    std::span<const uint8_t> icc;
+    /// Raw TIFF Exif, Exif with the JPEG APP1 "Exif\0\0" signature, or a ready JXL Exif box payload
+    std::span<const uint8_t> exif;
+    /// XMP packet, written as the "xml " box
+    std::span<const uint8_t> xmp;
+    /// JUMBF superbox contents, written as the "jumb" box
+    std::span<const uint8_t> jumbf;
+    /// Writes the boxes Brotli compressed as "brob" boxes
+    bool compressBoxes = false;
+
+    bool hasBoxes() const {
+        return !exif.empty() || !xmp.empty() || !jumbf.empty();
+    }
+};
+
+/**
+ * Enables the container with boxes, must be called before the basic info is set.
+ */
+static inline bool PrepareMetadataBoxes(JxlEncoder *enc, const JxlEncoderMetadata &metadata) {
+    if (!metadata.hasBoxes()) {
+        return true;
+    }
+    if (JXL_ENC_SUCCESS != JxlEncoderUseContainer(enc, JXL_TRUE)) {
+        return false;
+    }
+    return JXL_ENC_SUCCESS == JxlEncoderUseBoxes(enc);
+}
+
+/**
+ * Tags the image with the ICC profile when one is given, otherwise with sRGB.
+ * Must be called after the basic info is set.
+ */
+static inline bool ApplyColorProfile(JxlEncoder *enc, const JxlEncoderMetadata &metadata, bool isGray) {
+    if (!metadata.icc.empty()) {
+        return JXL_ENC_SUCCESS == JxlEncoderSetICCProfile(enc, metadata.icc.data(), metadata.icc.size());
+    }
+    JxlColorEncoding colorEncoding = {};
+    JxlColorEncodingSetToSRGB(&colorEncoding, isGray);
+    return JXL_ENC_SUCCESS == JxlEncoderSetColorEncoding(enc, &colorEncoding);
+}
+
+/**
+ * Adds every present metadata box and closes the box stream.
+ */
+static inline bool AddMetadataBoxes(JxlEncoder *enc, const JxlEncoderMetadata &metadata) {
+    if (!metadata.hasBoxes()) {
+        return true;
+    }
+    const JXL_BOOL compress = metadata.compressBoxes ? JXL_TRUE : JXL_FALSE;
+
+    if (!metadata.exif.empty()) {
+        const std::span<const uint8_t> &exif = metadata.exif;
+        const bool isTiff = exif.size() >= 4 &&
+                            (std::memcmp(exif.data(), "II*\0", 4) == 0 || std::memcmp(exif.data(), "MM\0*", 4) == 0);
+        const bool isApp1 = exif.size() >= 6 && std::memcmp(exif.data(), "Exif\0\0", 6) == 0;
+        if (isTiff || isApp1) {
+            // The Exif box starts with the offset of the TIFF header, since libjxl wants the box
+            // contiguous this is the one case where the payload has to be assembled
+            std::vector<uint8_t> box(exif.size() + 4);
+            box[3] = isApp1 ? 6 : 0;
+            std::copy(exif.begin(), exif.end(), box.begin() + 4);
+            if (JXL_ENC_SUCCESS != JxlEncoderAddBox(enc, "Exif", box.data(), box.size(), compress)) {
+                return false;
+            }
+        } else if (JXL_ENC_SUCCESS != JxlEncoderAddBox(enc, "Exif", exif.data(), exif.size(), compress)) {
+            return false;
+        }
+    }
+
+    if (!metadata.xmp.empty()) {
+        if (JXL_ENC_SUCCESS != JxlEncoderAddBox(enc, "xml ", metadata.xmp.data(), metadata.xmp.size(), compress)) {
+            return false;
+        }
+    }
+
+    if (!metadata.jumbf.empty()) {
+        if (JXL_ENC_SUCCESS != JxlEncoderAddBox(enc, "jumb", metadata.jumbf.data(), metadata.jumbf.size(), compress)) {
+            return false;
+        }
+    }
+
+    JxlEncoderCloseBoxes(enc);
+    return true;
+}
+
+}
+
+#endif
@@ -0,0 +1,158 @@
+//
+//  JxlEncoderOptions.hpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#pragma once
+
+#ifdef __cplusplus
+
+#include <jxl/encode.h>
+#include <utility>
+
+namespace jxlcoder {
+
+enum JxlEncoderPreset {
+    JXL_ENCODER_PRESET_DEFAULT = 0,
+    JXL_ENCODER_PRESET_FASTEST_ENCODE = 1,
+    JXL_ENCODER_PRESET_FASTEST_DECODE = 2,
+    JXL_ENCODER_PRESET_SMALLEST = 3,
+    JXL_ENCODER_PRESET_PROGRESSIVE_WEB = 4
+};
+
+/**
+ * Frame and codestream settings shared by the still, animated and transcoding encoders.
+ * Every field left at -1 keeps the libjxl default or the value the encoder was called with,
+ * see JxlEncoderFrameSettingId for the meaning of each value.
+ */
+struct JxlEncoderOptions {
+    /// Overrides the effort argument of the encoder, 1...9
+    int effort = -1;
+    /// Overrides the decoding speed argument of the encoder, 0...4
+    int decodingSpeed = -1;
+    /// 0 forces VarDCT, 1 forces modular
+    int modular = -1;
+    /// 0 buffers the whole frame, 1...3 trade compression for lower memory
+    int buffering = -1;
+    int progressiveDC = -1;
+    int progressiveAC = -1;
+    int qProgressiveAC = -1;
+    int responsive = -1;
+    /// 0 scanline order, 1 center first
+    int groupOrder = -1;
+    int patches = -1;
+    int dots = -1;
+    int gaborish = -1;
+    /// Edge preserving filter strength, 0...3
+    int epf = -1;
+    /// Brotli effort for compressed boxes and JPEG reconstruction data, 0...11
+    int brotliEffort = -1;
+    /// Codestream level, 5 or 10
+    int codestreamLevel = -1;
+
+    static JxlEncoderOptions preset(JxlEncoderPreset preset) {
+        JxlEncoderOptions options;
+        switch (preset) {
+            case JXL_ENCODER_PRESET_DEFAULT:
+                break;
+            case JXL_ENCODER_PRESET_FASTEST_ENCODE:
+                options.effort = 1;
+                options.patches = 0;
+                options.dots = 0;
+                options.gaborish = 0;
+                options.epf = 0;
+                options.brotliEffort = 0;
+                break;
+            case JXL_ENCODER_PRESET_FASTEST_DECODE:
+                options.decodingSpeed = 4;
+                options.gaborish = 0;
+                options.epf = 0;
+                options.progressiveDC = 0;
+                options.responsive = 0;
+                break;
+            case JXL_ENCODER_PRESET_SMALLEST:
+                options.effort = 9;
+                options.buffering = 0;
+                options.patches = 1;
+                options.dots = 1;
+                options.brotliEffort = 11;
+                break;
+            case JXL_ENCODER_PRESET_PROGRESSIVE_WEB:
+                options.progressiveDC = 1;
+                options.progressiveAC = 1;
+                options.qProgressiveAC = 1;
+                options.responsive = 1;
+                options.groupOrder = 1;
+                break;
+        }
+        return options;
+    }
+};
+
+/**
+ * Applies the codestream level, must be called before the basic info is set.
+ */
+static inline bool ApplyCodestreamLevel(JxlEncoder *enc, const JxlEncoderOptions &options) {
+    if (options.codestreamLevel < 0) {
+        return true;
+    }
+    return JXL_ENC_SUCCESS == JxlEncoderSetCodestreamLevel(enc, options.codestreamLevel);
+}
+
+/**
+ * Applies every set field of the options to the frame settings.
+ * Must be called after the encoder call's own effort and decoding speed were set, so overrides win.
+ */
+static inline bool ApplyFrameOptions(JxlEncoderFrameSettings *frameSettings, const JxlEncoderOptions &options) {
+    const std::pair<JxlEncoderFrameSettingId, int> settings[] = {
+        {JXL_ENC_FRAME_SETTING_EFFORT, options.effort},
+        {JXL_ENC_FRAME_SETTING_DECODING_SPEED, options.decodingSpeed},
+        {JXL_ENC_FRAME_SETTING_MODULAR, options.modular},
+        {JXL_ENC_FRAME_SETTING_BUFFERING, options.buffering},
+        {JXL_ENC_FRAME_SETTING_PROGRESSIVE_DC, options.progressiveDC},
+        {JXL_ENC_FRAME_SETTING_PROGRESSIVE_AC, options.progressiveAC},
+        {JXL_ENC_FRAME_SETTING_QPROGRESSIVE_AC, options.qProgressiveAC},
+        {JXL_ENC_FRAME_SETTING_RESPONSIVE, options.responsive},
+        {JXL_ENC_FRAME_SETTING_GROUP_ORDER, options.groupOrder},
+        {JXL_ENC_FRAME_SETTING_PATCHES, options.patches},
+        {JXL_ENC_FRAME_SETTING_DOTS, options.dots},
+        {JXL_ENC_FRAME_SETTING_GABORISH, options.gaborish},
+        {JXL_ENC_FRAME_SETTING_EPF, options.epf},
+        {JXL_ENC_FRAME_SETTING_BROTLI_EFFORT, options.brotliEffort},
+    };
+
+    for (const auto &setting: settings) {
+        if (setting.second < 0) {
+            continue;
+        }
+        if (JXL_ENC_SUCCESS != JxlEncoderFrameSettingsSetOption(frameSettings, setting.first, setting.second)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}
+
+#endif
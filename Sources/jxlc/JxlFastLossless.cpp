@@ -0,0 +1,137 @@
+//
+//  JxlFastLossless.cpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#include "JxlFastLossless.hpp"
+#include "JxlChannelAnalysis.hpp"
+#include "JxlEncoderMetadata.hpp"
+#include <jxl/encode.h>
+#include <jxl/encode_cxx.h>
+#include <jxl/thread_parallel_runner.h>
+#include <jxl/thread_parallel_runner_cxx.h>
+#include <algorithm>
+#include <utility>
+
+namespace jxlcoder {
+
+bool EncodeJxlFastLossless(const uint8_t *pixels, uint32_t stride, uint32_t xsize, uint32_t ysize,
+                           JxlPixelType colorspace, int effort, bool fastDecode, int numThreads,
+                           std::vector<uint8_t> *compressed) {
+    const int channels = JxlPixelTypeChannels(colorspace);
+    if (stride < xsize * channels) {
+        return false;
+    }
+
+    auto enc = JxlEncoderMake(nullptr);
+    JxlThreadParallelRunnerPtr runner;
+    if (numThreads != 1) {
+        runner = JxlThreadParallelRunnerMake(nullptr,
+                                             numThreads > 0 ? static_cast<size_t>(numThreads)
+                                             : JxlThreadParallelRunnerDefaultNumWorkerThreads());
+        if (JXL_ENC_SUCCESS != JxlEncoderSetParallelRunner(enc.get(),
+                                                           JxlThreadParallelRunner,
+                                                           runner.get())) {
+            return false;
+        }
+    }
+
+    const bool hasAlpha = colorspace == rgba || colorspace == grayAlpha;
+
+    // Rows are padded to the stride, libjxl rounds every row up to a multiple of align
+    JxlPixelFormat pixelFormat = {static_cast<uint32_t>(channels), JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN,
+                                  stride == xsize * channels ? 0 : static_cast<size_t>(stride)};
+
+    JxlBasicInfo basicInfo;
+    JxlEncoderInitBasicInfo(&basicInfo);
+    basicInfo.xsize = xsize;
+    basicInfo.ysize = ysize;
+    basicInfo.bits_per_sample = 8;
+    basicInfo.uses_original_profile = JXL_TRUE;
+    basicInfo.num_color_channels = channels < 3 ? 1 : 3;
+    if (hasAlpha) {
+        basicInfo.num_extra_channels = 1;
+        basicInfo.alpha_bits = 8;
+    }
+
+    if (JXL_ENC_SUCCESS != JxlEncoderSetBasicInfo(enc.get(), &basicInfo)) {
+        return false;
+    }
+
+    if (!ApplyColorProfile(enc.get(), JxlEncoderMetadata(), channels < 3)) {
+        return false;
+    }
+
+    JxlEncoderFrameSettings *frameSettings = JxlEncoderFrameSettingsCreate(enc.get(), nullptr);
+
+    if (JXL_ENC_SUCCESS != JxlEncoderSetFrameLossless(frameSettings, JXL_TRUE)) {
+        return false;
+    }
+
+    const std::pair<JxlEncoderFrameSettingId, int64_t> settings[] = {
+        {JXL_ENC_FRAME_SETTING_EFFORT, std::clamp(effort, 1, 2)},
+        {JXL_ENC_FRAME_SETTING_MODULAR, 1},
+        // Screen content rarely benefits from a progressive layout, it only costs time on both ends
+        {JXL_ENC_FRAME_SETTING_RESPONSIVE, 0},
+        {JXL_ENC_FRAME_SETTING_DECODING_SPEED, fastDecode ? 4 : 0},
+    };
+
+    for (const auto &setting: settings) {
+        if (JXL_ENC_SUCCESS != JxlEncoderFrameSettingsSetOption(frameSettings, setting.first, setting.second)) {
+            return false;
+        }
+    }
+
+    if (fastDecode) {
+        // The gradient predictor is the cheapest one to undo that still catches flat UI areas
+        if (JXL_ENC_SUCCESS != JxlEncoderFrameSettingsSetOption(frameSettings,
+                                                                JXL_ENC_FRAME_SETTING_MODULAR_PREDICTOR, 5)) {
+            return false;
+        }
+    }
+
+    if (JXL_ENC_SUCCESS != JxlEncoderAddImageFrame(frameSettings, &pixelFormat, pixels,
+                                                   static_cast<size_t>(stride) * ysize)) {
+        return false;
+    }
+
+    JxlEncoderCloseInput(enc.get());
+
+    compressed->resize(std::max<size_t>(static_cast<size_t>(xsize) * ysize / 4, 64));
+    uint8_t *nextOut = compressed->data();
+    size_t availOut = compressed->size();
+    JxlEncoderStatus processResult = JXL_ENC_NEED_MORE_OUTPUT;
+    while (processResult == JXL_ENC_NEED_MORE_OUTPUT) {
+        processResult = JxlEncoderProcessOutput(enc.get(), &nextOut, &availOut);
+        if (processResult == JXL_ENC_NEED_MORE_OUTPUT) {
+            size_t offset = nextOut - compressed->data();
+            compressed->resize(compressed->size() * 2);
+            nextOut = compressed->data() + offset;
+            availOut = compressed->size() - offset;
+        }
+    }
+    compressed->resize(nextOut - compressed->data());
+    return processResult == JXL_ENC_SUCCESS;
+}
+
+}
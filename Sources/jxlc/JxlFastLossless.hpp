@@ -0,0 +1,53 @@
+//
+//  JxlFastLossless.hpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#pragma once
+
+#ifdef __cplusplus
+
+#include <cstdint>
+#include <vector>
+#include "JxlDefinitions.h"
+
+namespace jxlcoder {
+
+/**
+ * Lossless encoding tuned for throughput on screenshots and UI captures.
+ * Runs modular at effort 1 or 2, at effort 1 libjxl takes its dedicated fast lossless encoder
+ * for 8-bit input, the rows are read in place so a bitmap context can be passed directly.
+ *
+ * @param pixels interleaved 8-bit pixels in the layout of colorspace
+ * @param stride bytes between rows, at least xsize * channels
+ * @param effort 1 or 2, values outside are clamped
+ * @param fastDecode trades a little density for cheaper decoding
+ * @param numThreads worker threads for libjxl, groups are encoded in parallel, 0 means one per core
+ */
+bool EncodeJxlFastLossless(const uint8_t *pixels, uint32_t stride, uint32_t xsize, uint32_t ysize,
+                           JxlPixelType colorspace, int effort, bool fastDecode, int numThreads,
+                           std::vector<uint8_t> *compressed);
+
+}
+
+#endif
@@ -0,0 +1,158 @@
+//
+//  JxlFrameDiff.cpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#include "JxlFrameDiff.hpp"
+#include <algorithm>
+
+#include <hwy/foreach_target.h>  // IWYU pragma: keep
+#include <hwy/highway.h>
+#include "hwy/base.h"
+
+namespace jxlcoder {
+
+using namespace hwy;
+using namespace hwy::HWY_NAMESPACE;
+
+/**
+ * First differing byte of two rows, or size when they are equal
+ */
+static size_t JxlFirstDifference(const uint8_t *__restrict__ a, const uint8_t *__restrict__ b, const size_t size) {
+    const ScalableTag<uint8_t> du8;
+    const size_t lanes = Lanes(du8);
+    size_t i = 0;
+    for (; i + lanes <= size; i += lanes) {
+        const auto differs = Ne(LoadU(du8, a + i), LoadU(du8, b + i));
+        if (!AllFalse(du8, differs)) {
+            return i + FindKnownFirstTrue(du8, differs);
+        }
+    }
+    for (; i < size; ++i) {
+        if (a[i] != b[i]) {
+            return i;
+        }
+    }
+    return size;
+}
+
+/**
+ * Last differing byte of two rows at or after start, rows must differ somewhere in that range
+ */
+static size_t JxlLastDifference(const uint8_t *__restrict__ a, const uint8_t *__restrict__ b,
+                                const size_t start, const size_t size) {
+    const ScalableTag<uint8_t> du8;
+    const size_t lanes = Lanes(du8);
+    size_t end = size;
+    while (end >= start + lanes) {
+        const auto differs = Ne(LoadU(du8, a + end - lanes), LoadU(du8, b + end - lanes));
+        if (!AllFalse(du8, differs)) {
+            return end - lanes + FindKnownLastTrue(du8, differs);
+        }
+        end -= lanes;
+    }
+    while (end > start) {
+        end -= 1;
+        if (a[end] != b[end]) {
+            return end;
+        }
+    }
+    return start;
+}
+
+bool JxlFindChangedRegion(const uint8_t *previous, const uint8_t *current,
+                          uint32_t width, uint32_t height, uint32_t bytesPerPixel,
+                          JxlChangedRegion *region) {
+    const size_t stride = static_cast<size_t>(width) * bytesPerPixel;
+    size_t minX = stride;
+    size_t maxX = 0;
+    int64_t minY = -1;
+    int64_t maxY = -1;
+
+    for (uint32_t y = 0; y < height; ++y) {
+        const uint8_t *a = previous + y * stride;
+        const uint8_t *b = current + y * stride;
+        const size_t first = JxlFirstDifference(a, b, stride);
+        if (first == stride) {
+            continue;
+        }
+        if (minY < 0) {
+            minY = y;
+        }
+        maxY = y;
+        minX = std::min(minX, first);
+        // Bytes before the known right edge can't move it any further
+        const size_t searchFrom = std::max(first, maxX);
+        maxX = std::max(maxX, JxlLastDifference(a, b, searchFrom, stride));
+    }
+
+    if (minY < 0) {
+        return false;
+    }
+    const uint32_t x0 = static_cast<uint32_t>(minX / bytesPerPixel);
+    const uint32_t x1 = static_cast<uint32_t>(maxX / bytesPerPixel);
+    region->x = x0;
+    region->y = static_cast<uint32_t>(minY);
+    region->width = x1 - x0 + 1;
+    region->height = static_cast<uint32_t>(maxY - minY + 1);
+    return true;
+}
+
+uint64_t JxlFrameHash(const uint8_t *data, size_t size) {
+    const ScalableTag<uint32_t> du32;
+    const Repartition<uint8_t, decltype(du32)> du8;
+    const size_t lanes = Lanes(du8);
+
+    const auto prime = Set(du32, 0x9E3779B1u);
+    // Four independent accumulators keep the multiplies from serializing
+    auto h0 = Set(du32, 0x85EBCA77u);
+    auto h1 = Set(du32, 0xC2B2AE3Du);
+    auto h2 = Set(du32, 0x27D4EB2Fu);
+    auto h3 = Set(du32, 0x165667B1u);
+
+    size_t i = 0;
+    for (; i + lanes * 4 <= size; i += lanes * 4) {
+        h0 = Mul(RotateRight<19>(Xor(h0, BitCast(du32, LoadU(du8, data + i)))), prime);
+        h1 = Mul(RotateRight<19>(Xor(h1, BitCast(du32, LoadU(du8, data + i + lanes)))), prime);
+        h2 = Mul(RotateRight<19>(Xor(h2, BitCast(du32, LoadU(du8, data + i + lanes * 2)))), prime);
+        h3 = Mul(RotateRight<19>(Xor(h3, BitCast(du32, LoadU(du8, data + i + lanes * 3)))), prime);
+    }
+    for (; i + lanes <= size; i += lanes) {
+        h0 = Mul(RotateRight<19>(Xor(h0, BitCast(du32, LoadU(du8, data + i)))), prime);
+    }
+
+    const auto mixed = Xor(Xor(h0, RotateRight<7>(h1)), Xor(RotateRight<13>(h2), RotateRight<23>(h3)));
+    HWY_ALIGN uint32_t state[HWY_MAX_LANES_D(ScalableTag<uint32_t>)];
+    Store(mixed, du32, state);
+
+    uint64_t hash = 0xCBF29CE484222325ull ^ static_cast<uint64_t>(size);
+    for (size_t lane = 0; lane < Lanes(du32); ++lane) {
+        hash = (hash ^ state[lane]) * 0x100000001B3ull;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ data[i]) * 0x100000001B3ull;
+    }
+    return hash ^ (hash >> 29);
+}
+
+}
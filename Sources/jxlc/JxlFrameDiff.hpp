@@ -0,0 +1,58 @@
+//
+//  JxlFrameDiff.hpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#pragma once
+
+#ifdef __cplusplus
+
+#include <cstdint>
+#include <cstddef>
+
+namespace jxlcoder {
+
+struct JxlChangedRegion {
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
+/**
+ * Bounding box of pixels that differ between two frames of the same layout, rows are tightly packed
+ * @param bytesPerPixel size of one interleaved pixel, every byte of it is compared
+ * @return false when the frames are identical
+ */
+bool JxlFindChangedRegion(const uint8_t *previous, const uint8_t *current,
+                          uint32_t width, uint32_t height, uint32_t bytesPerPixel,
+                          JxlChangedRegion *region);
+
+/**
+ * Fast non cryptographic hash of a frame, equal hashes still require a full compare
+ */
+uint64_t JxlFrameHash(const uint8_t *data, size_t size);
+
+}
+
+#endif
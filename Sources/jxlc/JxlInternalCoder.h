@@ -30,6 +30,7 @@
 #import "JXLSystemImage.hpp"
 #import "CJpegXLAnimatedEncoder.h"
 #import "CJpegXLAnimatedDecoder.h"
+#import "JXLEncoderOptions.h"
 
 @interface JxlInternalCoder: NSObject
 - (nullable JXLSystemImage *)decode:(nonnull NSInputStream *)inputStream
@@ -37,6 +38,10 @@
                              pixelFormat:(JXLPreferredPixelFormat)preferredPixelFormat
                              scale:(int)scale
                              error:(NSError *_Nullable * _Nullable)error;
+- (nullable JXLSystemImage *)decodePreview:(nonnull NSData *)data
+                             maxSize:(CGSize)maxSize
+                             scale:(int)scale
+                             error:(NSError *_Nullable * _Nullable)error;
 - (CGSize)getSize:(nonnull NSInputStream *)inputStream error:(NSError *_Nullable * _Nullable)error;
 - (nullable NSData *)encode:(nonnull JXLSystemImage *)platformImage
                      colorSpace:(JXLColorSpace)colorSpace
@@ -44,6 +49,45 @@
                      effort:(int)effort
                      quality:(int)quality
                      decodingSpeed:(JXLEncoderDecodingSpeed)decodingSpeed
+                     options:(nullable JXLEncoderOptions*)options
+                     error:(NSError * _Nullable *_Nullable)error;
+- (nullable NSData *)encode:(nonnull JXLSystemImage *)platformImage
+                     colorSpace:(JXLColorSpace)colorSpace
+                     effort:(int)effort
+                     decodingSpeed:(JXLEncoderDecodingSpeed)decodingSpeed
+                     rateTarget:(JXLRateControlTarget)rateTarget
+                     targetValue:(double)targetValue
+                     maxIterations:(int)maxIterations
+                     achievedDistance:(nonnull float*)achievedDistance
+                     achievedScore:(nonnull double*)achievedScore
+                     options:(nullable JXLEncoderOptions*)options
+                     error:(NSError * _Nullable *_Nullable)error;
+- (nullable NSArray<NSData *> *)encodeRenditions:(nonnull JXLSystemImage *)platformImage
+                     colorSpace:(JXLColorSpace)colorSpace
+                     widths:(nonnull NSArray<NSNumber *> *)widths
+                     qualities:(nonnull NSArray<NSNumber *> *)qualities
+                     efforts:(nonnull NSArray<NSNumber *> *)efforts
+                     decodingSpeed:(JXLEncoderDecodingSpeed)decodingSpeed
+                     options:(nullable JXLEncoderOptions*)options
+                     renditionWidths:(nonnull NSMutableArray<NSNumber *> *)renditionWidths
+                     renditionHeights:(nonnull NSMutableArray<NSNumber *> *)renditionHeights
+                     durations:(nonnull NSMutableArray<NSNumber *> *)durations
+                     error:(NSError * _Nullable *_Nullable)error;
+- (nullable NSData *)encodeFastLossless:(nonnull JXLSystemImage *)platformImage
+                     effort:(int)effort
+                     fastDecode:(bool)fastDecode
+                     error:(NSError * _Nullable *_Nullable)error;
+- (nullable NSArray<NSData *> *)encodeBatch:(nonnull NSArray<JXLSystemImage *> *)images
+                     colorSpace:(JXLColorSpace)colorSpace
+                     compressionOption:(JXLCompressionOption)compressionOption
+                     effort:(int)effort
+                     quality:(int)quality
+                     decodingSpeed:(JXLEncoderDecodingSpeed)decodingSpeed
+                     options:(nullable JXLEncoderOptions*)options
+                     coreBudget:(int)coreBudget
+                     latencies:(nonnull NSMutableArray<NSNumber *> *)latencies
+                     imagesPerSecond:(nonnull double*)imagesPerSecond
+                     megapixelsPerSecond:(nonnull double*)megapixelsPerSecond
                      error:(NSError * _Nullable *_Nullable)error;
 @end
 
@@ -30,6 +30,12 @@
 #import <Accelerate/Accelerate.h>
 #import "RgbRgbaConverter.hpp"
 #import "RgbaScaler.h"
+#import "JxlChannelAnalysis.hpp"
+#import "JxlRateControl.hpp"
+#import "JxlBatchEncoder.hpp"
+#import "JxlFastLossless.hpp"
+#import "JxlPreview.hpp"
+#import "JxlRenditions.hpp"
 #import <algorithm>
 
 static void JXLCGData8ProviderReleaseDataCallback(void *info, const void *data, size_t size) {
@@ -49,6 +55,69 @@ static inline float JXLGetDistance(const int quality)
     return distance;
 }
 
+static bool JXLPreparePixels(JXLSystemImage *platformImage, JXLColorSpace colorSpace,
+                             NSData * _Nullable iccProfile,
+                             std::vector<uint8_t> &pixels, int *width, int *height,
+                             JxlPixelType *pixelType, NSError * _Nullable *_Nullable error) {
+    CGColorSpaceRef targetColorSpace = nullptr;
+    if (iccProfile) {
+        targetColorSpace = CGColorSpaceCreateWithICCData((__bridge CFDataRef)iccProfile);
+        if (!targetColorSpace || CGColorSpaceGetModel(targetColorSpace) != kCGColorSpaceModelRGB) {
+            if (targetColorSpace) {
+                CGColorSpaceRelease(targetColorSpace);
+            }
+            *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Only valid RGB ICC profiles are supported" }];
+            return false;
+        }
+    }
+    auto imageRetrievingResult = [platformImage jxlRGBAPixels:pixels width:width height:height colorSpace:targetColorSpace];
+    if (targetColorSpace) {
+        CGColorSpaceRelease(targetColorSpace);
+    }
+    if (*width < 0 || *height < 0) {
+        *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Width and height must be > 0!!" }];
+        return false;
+    }
+    if (!imageRetrievingResult) {
+        *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Can' create preview of image" }];
+        return false;
+    }
+
+    switch (colorSpace) {
+        case kRGB:
+            *pixelType = rgb;
+            break;
+        case kRGBA:
+            *pixelType = rgba;
+            break;
+        case kAutomatic:
+            *pixelType = jxlcoder::AnalyzeRGBAChannels(pixels.data(), *width * 4, *width, *height);
+            // An RGB profile cannot describe a single gray channel
+            if (iccProfile && *pixelType == gray) {
+                *pixelType = rgb;
+            } else if (iccProfile && *pixelType == grayAlpha) {
+                *pixelType = rgba;
+            }
+            break;
+    }
+
+    if (colorSpace == kAutomatic) {
+        if (*pixelType != rgba) {
+            std::vector<uint8_t> reducedVector;
+            jxlcoder::ReduceRGBAChannels(pixels.data(), *width * 4, *width, *height, *pixelType, reducedVector);
+            pixels = std::move(reducedVector);
+        }
+    } else if (*pixelType == rgb) {
+        auto resizedVector = [RgbRgbaConverter convertRGBAtoRGB:pixels width:*width height:*height];
+        if (resizedVector.size() == 1) {
+            *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Cannot convert RGBA pixels to RGB" }];
+            return false;
+        }
+        pixels = resizedVector;
+    }
+    return true;
+}
+
 @implementation JxlInternalCoder
 - (nullable NSData *)encode:(nonnull JXLSystemImage *)platformImage
                  colorSpace:(JXLColorSpace)colorSpace
@@ -56,6 +125,7 @@ static inline float JXLGetDistance(const int quality)
                      effort:(int)effort
                     quality:(int)quality
               decodingSpeed:(JXLEncoderDecodingSpeed)decodingSpeed
+                    options:(nullable JXLEncoderOptions*)options
                       error:(NSError * _Nullable *_Nullable)error {
     try {
         if (quality < 0 || quality > 100) {
@@ -70,28 +140,13 @@ static inline float JXLGetDistance(const int quality)
 
         std::vector<uint8_t> pixels;
         int width, height;
-        auto imageRetrievingResult = [platformImage jxlRGBAPixels:pixels width:&width height:&height];
-        if (width < 0 || height < 0) {
-            *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Width and height must be > 0!!" }];
-            return nil;
-        }
-        if (!imageRetrievingResult) {
-            *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Can' create preview of image" }];
+        JxlPixelType jColorspace;
+        if (!JXLPreparePixels(platformImage, colorSpace, options.iccProfile, pixels, &width, &height, &jColorspace, error)) {
             return nil;
         }
 
-        JxlPixelType jColorspace;
         JxlCompressionOption jCompressionOption;
 
-        switch (colorSpace) {
-            case kRGB:
-                jColorspace = rgb;
-                break;
-            case kRGBA:
-                jColorspace = rgba;
-                break;
-        }
-
         switch (compressionOption) {
             case kLoseless:
                 jCompressionOption = loseless;
@@ -101,19 +156,12 @@ static inline float JXLGetDistance(const int quality)
                 break;
         }
 
-        if (jColorspace == rgb) {
-            auto resizedVector = [RgbRgbaConverter convertRGBAtoRGB:pixels width:width height:height];
-            if (resizedVector.size() == 1) {
-                *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Cannot convert RGBA pixels to RGB" }];
-                return nil;
-            }
-            pixels = resizedVector;
-        }
-
         JXLDataWrapper<uint8_t>* wrapper = new JXLDataWrapper<uint8_t>();
         auto encoded = EncodeJxlOneshot(pixels, width, height, &wrapper->data, 
                                         jColorspace, jCompressionOption, JXLGetDistance(quality),
-                                        effort, (int)decodingSpeed);
+                                        effort, (int)decodingSpeed, 0,
+                                        options ? [options jxlOptions] : jxlcoder::JxlEncoderOptions(),
+                                        options ? [options jxlMetadata] : jxlcoder::JxlEncoderMetadata());
         if (!encoded) {
             delete wrapper;
             *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Cannot encode JXL image" }];
@@ -137,6 +185,287 @@ static inline float JXLGetDistance(const int quality)
     }
 }
 
+- (nullable NSData *)encode:(nonnull JXLSystemImage *)platformImage
+                 colorSpace:(JXLColorSpace)colorSpace
+                     effort:(int)effort
+              decodingSpeed:(JXLEncoderDecodingSpeed)decodingSpeed
+                 rateTarget:(JXLRateControlTarget)rateTarget
+                targetValue:(double)targetValue
+              maxIterations:(int)maxIterations
+           achievedDistance:(nonnull float*)achievedDistance
+              achievedScore:(nonnull double*)achievedScore
+                    options:(nullable JXLEncoderOptions*)options
+                      error:(NSError * _Nullable *_Nullable)error {
+    try {
+        if (effort < 1 || effort > 9) {
+            *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Effort must be clamped in 1...9" }];
+            return nil;
+        }
+
+        if (targetValue <= 0 || maxIterations < 1) {
+            *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Target value and max iterations must be > 0" }];
+            return nil;
+        }
+
+        std::vector<uint8_t> pixels;
+        int width, height;
+        JxlPixelType jColorspace;
+        if (!JXLPreparePixels(platformImage, colorSpace, options.iccProfile, pixels, &width, &height, &jColorspace, error)) {
+            return nil;
+        }
+
+        jxlcoder::JxlRateControlTarget jTarget;
+        switch (rateTarget) {
+            case kTargetSize:
+                jTarget = jxlcoder::JXL_RATE_CONTROL_SIZE;
+                break;
+            case kTargetPSNR:
+                jTarget = jxlcoder::JXL_RATE_CONTROL_PSNR;
+                break;
+        }
+
+        JXLDataWrapper<uint8_t>* wrapper = new JXLDataWrapper<uint8_t>();
+        jxlcoder::JxlRateControlResult result;
+        auto encoded = jxlcoder::EncodeJxlRateControlled(pixels, width, height, jColorspace,
+                                                         effort, (int)decodingSpeed,
+                                                         jTarget, targetValue, maxIterations,
+                                                         &wrapper->data, &result,
+                                                         options ? [options jxlOptions] : jxlcoder::JxlEncoderOptions(),
+                                                         options ? [options jxlMetadata] : jxlcoder::JxlEncoderMetadata());
+        if (!encoded) {
+            delete wrapper;
+            *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Cannot encode JXL image" }];
+            return nil;
+        }
+
+        *achievedDistance = result.distance;
+        *achievedScore = result.psnr;
+
+        auto data = [[NSData alloc] initWithBytesNoCopy:wrapper->data.data()
+                                                 length:wrapper->data.size()
+                                            deallocator:^(void * _Nonnull bytes, NSUInteger length) {
+            delete wrapper;
+        }];
+
+        return data;
+    } catch (std::bad_alloc &err) {
+        *error = [[NSError alloc] initWithDomain:@"JXLCoder"
+                                            code:500
+                                        userInfo:@{ NSLocalizedDescriptionKey: [NSString stringWithFormat:@"Encoding image memory error: %s", err.what()] }];
+        return nullptr;
+    }
+}
+
+- (nullable NSArray<NSData *> *)encodeRenditions:(nonnull JXLSystemImage *)platformImage
+                                       colorSpace:(JXLColorSpace)colorSpace
+                                           widths:(nonnull NSArray<NSNumber *> *)widths
+                                        qualities:(nonnull NSArray<NSNumber *> *)qualities
+                                          efforts:(nonnull NSArray<NSNumber *> *)efforts
+                                    decodingSpeed:(JXLEncoderDecodingSpeed)decodingSpeed
+                                          options:(nullable JXLEncoderOptions*)options
+                                  renditionWidths:(nonnull NSMutableArray<NSNumber *> *)renditionWidths
+                                 renditionHeights:(nonnull NSMutableArray<NSNumber *> *)renditionHeights
+                                        durations:(nonnull NSMutableArray<NSNumber *> *)durations
+                                            error:(NSError * _Nullable *_Nullable)error {
+    try {
+        if (widths.count != qualities.count || widths.count != efforts.count) {
+            *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Every rendition must have a width, quality and effort" }];
+            return nil;
+        }
+
+        std::vector<jxlcoder::JxlRenditionTarget> targets(widths.count);
+        for (NSUInteger i = 0; i < widths.count; ++i) {
+            const int width = [widths[i] intValue];
+            const int quality = [qualities[i] intValue];
+            const int effort = [efforts[i] intValue];
+            if (width < 1) {
+                *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Rendition width must be > 0" }];
+                return nil;
+            }
+            if (quality < 0 || quality > 100) {
+                *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Quality must be clamped in 0...100" }];
+                return nil;
+            }
+            if (effort < 1 || effort > 9) {
+                *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Effort must be clamped in 1...9" }];
+                return nil;
+            }
+            targets[i] = { .width = static_cast<uint32_t>(width), .distance = JXLGetDistance(quality), .effort = effort };
+        }
+
+        std::vector<uint8_t> pixels;
+        int width, height;
+        JxlPixelType jColorspace;
+        if (!JXLPreparePixels(platformImage, colorSpace, options.iccProfile, pixels, &width, &height, &jColorspace, error)) {
+            return nil;
+        }
+
+        std::vector<jxlcoder::JxlRendition> renditions;
+        auto encoded = jxlcoder::EncodeJxlRenditions(pixels, width, height, jColorspace, targets,
+                                                     (int)decodingSpeed,
+                                                     options ? [options jxlOptions] : jxlcoder::JxlEncoderOptions(),
+                                                     &renditions, 0,
+                                                     options ? [options jxlMetadata] : jxlcoder::JxlEncoderMetadata());
+        pixels.clear();
+        if (!encoded) {
+            *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Cannot encode JXL image" }];
+            return nil;
+        }
+
+        NSMutableArray<NSData *> *result = [[NSMutableArray alloc] initWithCapacity:renditions.size()];
+        for (auto &rendition: renditions) {
+            JXLDataWrapper<uint8_t>* wrapper = new JXLDataWrapper<uint8_t>();
+            wrapper->data = std::move(rendition.compressed);
+            auto data = [[NSData alloc] initWithBytesNoCopy:wrapper->data.data()
+                                                     length:wrapper->data.size()
+                                                deallocator:^(void * _Nonnull bytes, NSUInteger length) {
+                delete wrapper;
+            }];
+            [result addObject:data];
+            [renditionWidths addObject:@(rendition.width)];
+            [renditionHeights addObject:@(rendition.height)];
+            [durations addObject:@((rendition.resampleTime + rendition.encodeTime) / 1000.0)];
+        }
+
+        return result;
+    } catch (std::bad_alloc &err) {
+        *error = [[NSError alloc] initWithDomain:@"JXLCoder"
+                                            code:500
+                                        userInfo:@{ NSLocalizedDescriptionKey: [NSString stringWithFormat:@"Encoding image memory error: %s", err.what()] }];
+        return nullptr;
+    }
+}
+
+- (nullable NSData *)encodeFastLossless:(nonnull JXLSystemImage *)platformImage
+                                 effort:(int)effort
+                             fastDecode:(bool)fastDecode
+                                  error:(NSError * _Nullable *_Nullable)error {
+    try {
+        if (effort < 1 || effort > 2) {
+            *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Fast lossless effort must be 1 or 2" }];
+            return nil;
+        }
+
+        // Bitmap contexts hand out RGBA8 already, it goes to the encoder without any repacking
+        std::vector<uint8_t> pixels;
+        int width, height;
+        if (![platformImage jxlRGBAPixels:pixels width:&width height:&height] || width <= 0 || height <= 0) {
+            *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Can't recieve an image from Platform image" }];
+            return nil;
+        }
+
+        JXLDataWrapper<uint8_t>* wrapper = new JXLDataWrapper<uint8_t>();
+        auto encoded = jxlcoder::EncodeJxlFastLossless(pixels.data(), width * 4, width, height, rgba,
+                                                       effort, fastDecode, 0, &wrapper->data);
+        if (!encoded) {
+            delete wrapper;
+            *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Cannot encode JXL image" }];
+            return nil;
+        }
+
+        auto data = [[NSData alloc] initWithBytesNoCopy:wrapper->data.data()
+                                                 length:wrapper->data.size()
+                                            deallocator:^(void * _Nonnull bytes, NSUInteger length) {
+            delete wrapper;
+        }];
+
+        return data;
+    } catch (std::bad_alloc &err) {
+        *error = [[NSError alloc] initWithDomain:@"JXLCoder"
+                                            code:500
+                                        userInfo:@{ NSLocalizedDescriptionKey: [NSString stringWithFormat:@"Encoding image memory error: %s", err.what()] }];
+        return nullptr;
+    }
+}
+
+- (nullable NSArray<NSData *> *)encodeBatch:(nonnull NSArray<JXLSystemImage *> *)images
+                                  colorSpace:(JXLColorSpace)colorSpace
+                           compressionOption:(JXLCompressionOption)compressionOption
+                                      effort:(int)effort
+                                     quality:(int)quality
+                               decodingSpeed:(JXLEncoderDecodingSpeed)decodingSpeed
+                                     options:(nullable JXLEncoderOptions*)options
+                                  coreBudget:(int)coreBudget
+                                   latencies:(nonnull NSMutableArray<NSNumber *> *)latencies
+                             imagesPerSecond:(nonnull double*)imagesPerSecond
+                         megapixelsPerSecond:(nonnull double*)megapixelsPerSecond
+                                       error:(NSError * _Nullable *_Nullable)error {
+    try {
+        if (quality < 0 || quality > 100) {
+            *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Quality must be clamped in 0...100" }];
+            return nil;
+        }
+
+        if (effort < 1 || effort > 9) {
+            *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Effort must be clamped in 1...9" }];
+            return nil;
+        }
+
+        JxlCompressionOption jCompressionOption;
+
+        switch (compressionOption) {
+            case kLoseless:
+                jCompressionOption = loseless;
+                break;
+            case kLossy:
+                jCompressionOption = loosy;
+                break;
+        }
+
+        const jxlcoder::JxlEncoderOptions jOptions = options ? [options jxlOptions] : jxlcoder::JxlEncoderOptions();
+        const jxlcoder::JxlEncoderMetadata jMetadata = options ? [options jxlMetadata] : jxlcoder::JxlEncoderMetadata();
+
+        std::vector<jxlcoder::JxlBatchJob> jobs(images.count);
+        for (NSUInteger i = 0; i < images.count; ++i) {
+            int width, height;
+            jxlcoder::JxlBatchJob &job = jobs[i];
+            if (!JXLPreparePixels(images[i], colorSpace, options.iccProfile, job.pixels, &width, &height, &job.colorspace, error)) {
+                return nil;
+            }
+            job.xsize = width;
+            job.ysize = height;
+            job.compressionOption = jCompressionOption;
+            job.distance = JXLGetDistance(quality);
+            job.effort = effort;
+            job.decodingSpeed = (int)decodingSpeed;
+            job.options = jOptions;
+            job.metadata = jMetadata;
+        }
+
+        jxlcoder::JxlBatchEncoder encoder(coreBudget);
+        jxlcoder::JxlBatchStatistics statistics;
+        auto results = encoder.encode(jobs, &statistics);
+        jobs.clear();
+
+        NSMutableArray<NSData *> *encoded = [[NSMutableArray alloc] initWithCapacity:results.size()];
+        for (auto &result: results) {
+            if (!result.succeed) {
+                *error = [[NSError alloc] initWithDomain:@"JXLCoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Cannot encode JXL image" }];
+                return nil;
+            }
+            JXLDataWrapper<uint8_t>* wrapper = new JXLDataWrapper<uint8_t>();
+            wrapper->data = std::move(result.compressed);
+            auto data = [[NSData alloc] initWithBytesNoCopy:wrapper->data.data()
+                                                     length:wrapper->data.size()
+                                                deallocator:^(void * _Nonnull bytes, NSUInteger length) {
+                delete wrapper;
+            }];
+            [encoded addObject:data];
+            [latencies addObject:@(result.latency / 1000.0)];
+        }
+
+        *imagesPerSecond = statistics.imagesPerSecond;
+        *megapixelsPerSecond = statistics.megapixelsPerSecond;
+
+        return encoded;
+    } catch (std::bad_alloc &err) {
+        *error = [[NSError alloc] initWithDomain:@"JXLCoder"
+                                            code:500
+                                        userInfo:@{ NSLocalizedDescriptionKey: [NSString stringWithFormat:@"Encoding image memory error: %s", err.what()] }];
+        return nullptr;
+    }
+}
+
 - (CGSize)getSize:(nonnull NSInputStream *)inputStream error:(NSError *_Nullable * _Nullable)error {
     try {
         int bufferLength = 30196;
@@ -186,6 +515,79 @@ static inline float JXLGetDistance(const int quality)
     }
 }
 
+- (nullable JXLSystemImage *)decodePreview:(nonnull NSData *)data
+                                   maxSize:(CGSize)maxSize
+                                     scale:(int)scale
+                                     error:(NSError *_Nullable * _Nullable)error {
+    try {
+        std::vector<uint8_t> iccProfile;
+        auto dataWrapper = new JXLDataWrapper<uint8_t>();
+        uint32_t xSize, ySize;
+        jxlcoder::JxlPreviewSource source;
+        auto decoded = jxlcoder::DecodeJxlPreview(reinterpret_cast<const uint8_t*>([data bytes]), [data length],
+                                                  (uint32_t)std::max(maxSize.width, 0.0),
+                                                  (uint32_t)std::max(maxSize.height, 0.0),
+                                                  &dataWrapper->data, &xSize, &ySize, &iccProfile, &source);
+        if (!decoded) {
+            delete dataWrapper;
+            *error = [[NSError alloc] initWithDomain:@"JXLCoder"
+                                                code:500
+                                            userInfo:@{ NSLocalizedDescriptionKey: @"Failed to decode JXL preview" }];
+            return nil;
+        }
+
+        CGColorSpaceRef colorSpace = nullptr;
+        if (iccProfile.size() > 0) {
+            CFDataRef iccData = CFDataCreate(kCFAllocatorDefault, iccProfile.data(), iccProfile.size());
+            colorSpace = CGColorSpaceCreateWithICCData(iccData);
+            CFRelease(iccData);
+        }
+        if (!colorSpace) {
+            colorSpace = CGColorSpaceCreateDeviceRGB();
+        }
+
+        CGDataProviderRef provider = CGDataProviderCreateWithData(dataWrapper,
+                                                                  dataWrapper->data.data(),
+                                                                  dataWrapper->data.size(),
+                                                                  JXLCGData8ProviderReleaseDataCallback);
+        if (!provider) {
+            delete dataWrapper;
+            CGColorSpaceRelease(colorSpace);
+            *error = [[NSError alloc] initWithDomain:@"JXLCoder"
+                                                code:500
+                                            userInfo:@{ NSLocalizedDescriptionKey: @"CoreGraphics cannot allocate required provider" }];
+            return nullptr;
+        }
+
+        CGImageRef imageRef = CGImageCreate(xSize, ySize, 8, 32, xSize * 4, colorSpace,
+                                            (int)kCGImageByteOrderDefault | (int)kCGImageAlphaLast,
+                                            provider, NULL, false, kCGRenderingIntentDefault);
+        CGDataProviderRelease(provider);
+        CGColorSpaceRelease(colorSpace);
+        if (!imageRef) {
+            *error = [[NSError alloc] initWithDomain:@"JXLCoder"
+                                                code:500
+                                            userInfo:@{ NSLocalizedDescriptionKey: @"CoreGraphics cannot allocate CGImageRef" }];
+            return nullptr;
+        }
+
+        JXLSystemImage *image = nil;
+#if JXL_PLUGIN_MAC
+        image = [[NSImage alloc] initWithCGImage:imageRef size:CGSizeZero];
+#else
+        image = [UIImage imageWithCGImage:imageRef scale:scale orientation:UIImageOrientationUp];
+#endif
+        CGImageRelease(imageRef);
+
+        return image;
+    } catch (std::bad_alloc &err) {
+        *error = [[NSError alloc] initWithDomain:@"JXLCoder"
+                                            code:500
+                                        userInfo:@{ NSLocalizedDescriptionKey: [NSString stringWithFormat:@"Decoding image memory error: %s", err.what()] }];
+        return nullptr;
+    }
+}
+
 - (nullable JXLSystemImage *)decode:(nonnull NSInputStream *)inputStream
                             rescale:(CGSize)rescale
                         pixelFormat:(JXLPreferredPixelFormat)preferredPixelFormat
@@ -249,6 +651,8 @@ static inline float JXLGetDistance(const int quality)
                 pixelFormat = r8;
                 break;
             case kFloat16:
+            case kR16:
+            case kFloat32:
                 pixelFormat = float16;
                 break;
         }
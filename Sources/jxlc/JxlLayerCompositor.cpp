@@ -0,0 +1,187 @@
+//
+//  JxlLayerCompositor.cpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#include "JxlLayerCompositor.hpp"
+#include <algorithm>
+#include <cstring>
+
+#include <hwy/foreach_target.h>  // IWYU pragma: keep
+#include <hwy/highway.h>
+#include "hwy/base.h"
+
+namespace jxlcoder {
+
+using namespace hwy;
+using namespace hwy::HWY_NAMESPACE;
+
+static void JxlBlendRowAdd(const uint8_t *__restrict__ src, uint8_t *__restrict__ dst, const size_t size) {
+    const ScalableTag<uint8_t> du8;
+    const size_t lanes = Lanes(du8);
+    size_t i = 0;
+    for (; i + lanes <= size; i += lanes) {
+        StoreU(SaturatedAdd(LoadU(du8, dst + i), LoadU(du8, src + i)), du8, dst + i);
+    }
+    for (; i < size; ++i) {
+        dst[i] = static_cast<uint8_t>(std::min(dst[i] + src[i], 255));
+    }
+}
+
+/**
+ * Blending of unassociated alpha: one RGBA pixel per vector, so alpha is broadcast across the lanes
+ */
+static void JxlBlendRowFloat(const uint8_t *__restrict__ src, uint8_t *__restrict__ dst,
+                             const uint32_t pixels, const JxlBlendMode mode) {
+    const FixedTag<float, 4> df;
+    const Rebind<int32_t, decltype(df)> di;
+    const Rebind<uint8_t, decltype(df)> du8;
+    using VF = Vec<decltype(df)>;
+    const VF scale = Set(df, 1.f / 255.f);
+    const VF maxColors = Set(df, 255.f);
+    const VF ones = Set(df, 1.f);
+    const VF zeros = Zero(df);
+    const auto colorLanes = FirstN(df, 3);
+
+    for (uint32_t x = 0; x < pixels; ++x) {
+        const VF fg = Mul(ConvertTo(df, PromoteTo(di, LoadU(du8, src + x * 4))), scale);
+        const VF bg = Mul(ConvertTo(df, PromoteTo(di, LoadU(du8, dst + x * 4))), scale);
+        const VF fa = Broadcast<3>(fg);
+        const VF ba = Broadcast<3>(bg);
+        VF result;
+        if (mode == JXL_BLEND_BLEND) {
+            const VF bgWeight = Mul(ba, Sub(ones, fa));
+            const VF alpha = Add(fa, bgWeight);
+            const VF color = MulAdd(fg, fa, Mul(bg, bgWeight));
+            const VF colors = IfThenElse(Gt(alpha, zeros), Div(color, alpha), zeros);
+            result = IfThenElse(colorLanes, colors, alpha);
+        } else if (mode == JXL_BLEND_MULADD) {
+            result = IfThenElse(colorLanes, MulAdd(fg, fa, bg), ba);
+        } else {
+            result = Mul(fg, bg);
+        }
+        result = Min(Max(Mul(result, maxColors), zeros), maxColors);
+        StoreU(DemoteTo(du8, NearestInt(result)), du8, dst + x * 4);
+    }
+}
+
+}
+
+JxlRect JxlRect::united(const JxlRect& other) const {
+    if (empty()) {
+        return other;
+    }
+    if (other.empty()) {
+        return *this;
+    }
+    const int left = std::min(x, other.x);
+    const int top = std::min(y, other.y);
+    const int right = std::max(x + width, other.x + other.width);
+    const int bottom = std::max(y + height, other.y + other.height);
+    return { .x = left, .y = top, .width = right - left, .height = bottom - top };
+}
+
+JxlLayerCompositor::JxlLayerCompositor(uint32_t width, uint32_t height) : width(width), height(height) {
+    canvas.resize(static_cast<size_t>(width) * height * 4);
+}
+
+void JxlLayerCompositor::reset() {
+    std::fill(canvas.begin(), canvas.end(), 0);
+    for (auto& reference : references) {
+        reference.clear();
+        reference.shrink_to_fit();
+    }
+    canvasMatches = 0xF;
+}
+
+void JxlLayerCompositor::copyRect(const uint8_t* src, uint8_t* dst, const JxlRect& rect) const {
+    const size_t stride = static_cast<size_t>(width) * 4;
+    for (int y = rect.y; y < rect.y + rect.height; ++y) {
+        const size_t offset = y * stride + static_cast<size_t>(rect.x) * 4;
+        std::memcpy(dst + offset, src + offset, static_cast<size_t>(rect.width) * 4);
+    }
+}
+
+JxlRect JxlLayerCompositor::apply(const JxlLayer& layer) {
+    const JxlRect full = { .x = 0, .y = 0, .width = static_cast<int>(width), .height = static_cast<int>(height) };
+    JxlRect dirty;
+
+    const int source = layer.source & 3;
+    if (!(canvasMatches & (1u << source))) {
+        if (references[source].empty()) {
+            std::fill(canvas.begin(), canvas.end(), 0);
+        } else {
+            std::copy(references[source].begin(), references[source].end(), canvas.begin());
+        }
+        canvasMatches = 1u << source;
+        dirty = full;
+    }
+
+    const int left = std::max(layer.x, 0);
+    const int top = std::max(layer.y, 0);
+    const int right = static_cast<int>(std::min<int64_t>(static_cast<int64_t>(layer.x) + layer.width, width));
+    const int bottom = static_cast<int>(std::min<int64_t>(static_cast<int64_t>(layer.y) + layer.height, height));
+    const JxlRect rect = { .x = left, .y = top, .width = right - left, .height = bottom - top };
+    const uint32_t matchesBefore = canvasMatches;
+
+    if (!rect.empty() && layer.pixels.size() >= static_cast<size_t>(layer.width) * layer.height * 4) {
+        const size_t stride = static_cast<size_t>(width) * 4;
+        const size_t layerStride = static_cast<size_t>(layer.width) * 4;
+        for (int y = top; y < bottom; ++y) {
+            const uint8_t* src = layer.pixels.data() + (y - layer.y) * layerStride + static_cast<size_t>(left - layer.x) * 4;
+            uint8_t* dst = canvas.data() + y * stride + static_cast<size_t>(left) * 4;
+            switch (layer.blendMode) {
+                case JXL_BLEND_REPLACE:
+                    std::memcpy(dst, src, static_cast<size_t>(rect.width) * 4);
+                    break;
+                case JXL_BLEND_ADD:
+                    jxlcoder::JxlBlendRowAdd(src, dst, static_cast<size_t>(rect.width) * 4);
+                    break;
+                default:
+                    jxlcoder::JxlBlendRowFloat(src, dst, rect.width, layer.blendMode);
+                    break;
+            }
+        }
+        dirty = dirty.united(rect);
+        canvasMatches = 0;
+    }
+
+    if (layer.saveAsReference >= 0) {
+        const int slot = layer.saveAsReference & 3;
+        std::vector<uint8_t>& reference = references[slot];
+        if (matchesBefore & (1u << slot)) {
+            // The slot held the canvas before blending, only the blended rectangle differs
+            if (reference.empty()) {
+                reference.resize(canvas.size(), 0);
+            }
+            if (!rect.empty()) {
+                copyRect(canvas.data(), reference.data(), rect);
+            }
+        } else {
+            reference.assign(canvas.begin(), canvas.end());
+        }
+        canvasMatches |= 1u << slot;
+    }
+
+    return dirty;
+}
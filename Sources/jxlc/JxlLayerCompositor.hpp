@@ -0,0 +1,96 @@
+//
+//  JxlLayerCompositor.hpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#ifndef JxlLayerCompositor_hpp
+#define JxlLayerCompositor_hpp
+
+#ifdef __cplusplus
+
+#include <cstdint>
+#include <array>
+#include <vector>
+#include "JxlAnimatedDecoder.hpp"
+
+struct JxlRect {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+
+    bool empty() const {
+        return width <= 0 || height <= 0;
+    }
+
+    JxlRect united(const JxlRect& other) const;
+};
+
+/**
+ * Blends non-coalesced layers onto a persistent RGBA8 canvas with the 4 reference slots of JPEG XL.
+ * As long as a layer is blended onto the slot the canvas already holds, only its crop rectangle
+ * is touched, so small layers cost proportionally to their own size, not to the canvas.
+ */
+class JxlLayerCompositor {
+public:
+    JxlLayerCompositor(uint32_t width, uint32_t height);
+
+    /**
+     * Blends the layer and saves the result into its reference slot when it is referenced later
+     * @return region of the canvas that changed since the previous call
+     */
+    JxlRect apply(const JxlLayer& layer);
+
+    /**
+     * Clears the canvas and reference slots, e.g. when the animation loops
+     */
+    void reset();
+
+    /// RGBA8 unpremultiplied, width * 4 bytes per row
+    const std::vector<uint8_t>& getCanvas() const {
+        return canvas;
+    }
+
+    uint32_t getWidth() const {
+        return width;
+    }
+
+    uint32_t getHeight() const {
+        return height;
+    }
+
+private:
+    void copyRect(const uint8_t* src, uint8_t* dst, const JxlRect& rect) const;
+
+    uint32_t width;
+    uint32_t height;
+    std::vector<uint8_t> canvas;
+    // Empty slots are transparent black, allocated on the first save
+    std::array<std::vector<uint8_t>, 4> references;
+    // Bit per reference slot whose content is identical to the canvas
+    uint32_t canvasMatches = 0xF;
+};
+
+#endif
+
+#endif /* JxlLayerCompositor_hpp */
@@ -0,0 +1,172 @@
+//
+//  JxlPreview.cpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#include "JxlPreview.hpp"
+#include "JxlResampler.hpp"
+#include <jxl/decode.h>
+#include <jxl/decode_cxx.h>
+#include <jxl/resizable_parallel_runner.h>
+#include <jxl/resizable_parallel_runner_cxx.h>
+#include <algorithm>
+#include <utility>
+
+namespace jxlcoder {
+
+bool DecodeJxlPreview(const uint8_t *jxl, size_t size, uint32_t maxWidth, uint32_t maxHeight,
+                      std::vector<uint8_t> *pixels, uint32_t *xsize, uint32_t *ysize,
+                      std::vector<uint8_t> *iccProfile, JxlPreviewSource *source) {
+    auto runner = JxlResizableParallelRunnerMake(nullptr);
+    auto dec = JxlDecoderMake(nullptr);
+
+    if (JXL_DEC_SUCCESS !=
+        JxlDecoderSubscribeEvents(dec.get(), JXL_DEC_BASIC_INFO |
+                                  JXL_DEC_COLOR_ENCODING |
+                                  JXL_DEC_PREVIEW_IMAGE |
+                                  JXL_DEC_FRAME_PROGRESSION |
+                                  JXL_DEC_FULL_IMAGE)) {
+        return false;
+    }
+
+    if (JXL_DEC_SUCCESS != JxlDecoderSetParallelRunner(dec.get(),
+                                                       JxlResizableParallelRunner,
+                                                       runner.get())) {
+        return false;
+    }
+
+    if (JXL_DEC_SUCCESS != JxlDecoderSetUnpremultiplyAlpha(dec.get(), JXL_TRUE)) {
+        return false;
+    }
+
+    if (JXL_DEC_SUCCESS != JxlDecoderSetProgressiveDetail(dec.get(), kDC)) {
+        return false;
+    }
+
+    // Input is left open on purpose, the caller may only have the head of the file
+    if (JXL_DEC_SUCCESS != JxlDecoderSetInput(dec.get(), jxl, size)) {
+        return false;
+    }
+
+    const JxlPixelFormat format = {4, JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
+    JxlBasicInfo info;
+    uint32_t width = 0, height = 0;
+    std::vector<uint8_t> decoded;
+    bool finished = false;
+
+    while (!finished) {
+        JxlDecoderStatus status = JxlDecoderProcessInput(dec.get());
+
+        if (status == JXL_DEC_ERROR) {
+            return false;
+        } else if (status == JXL_DEC_NEED_MORE_INPUT) {
+            return false;
+        } else if (status == JXL_DEC_BASIC_INFO) {
+            if (JXL_DEC_SUCCESS != JxlDecoderGetBasicInfo(dec.get(), &info)) {
+                return false;
+            }
+            JxlResizableParallelRunnerSetThreads(runner.get(),
+                                                 JxlResizableParallelRunnerSuggestThreads(info.xsize, info.ysize));
+        } else if (status == JXL_DEC_COLOR_ENCODING) {
+            size_t iccSize;
+            if (JXL_DEC_SUCCESS ==
+                JxlDecoderGetICCProfileSize(dec.get(), JXL_COLOR_PROFILE_TARGET_DATA, &iccSize)) {
+                iccProfile->resize(iccSize);
+                if (JXL_DEC_SUCCESS != JxlDecoderGetColorAsICCProfile(dec.get(), JXL_COLOR_PROFILE_TARGET_DATA,
+                                                                      iccProfile->data(), iccProfile->size())) {
+                    return false;
+                }
+            } else {
+                iccProfile->resize(0);
+            }
+        } else if (status == JXL_DEC_NEED_PREVIEW_OUT_BUFFER) {
+            size_t bufferSize;
+            if (JXL_DEC_SUCCESS != JxlDecoderPreviewOutBufferSize(dec.get(), &format, &bufferSize)) {
+                return false;
+            }
+            width = info.preview.xsize;
+            height = info.preview.ysize;
+            decoded.resize(bufferSize);
+            if (JXL_DEC_SUCCESS != JxlDecoderSetPreviewOutBuffer(dec.get(), &format,
+                                                                 decoded.data(), decoded.size())) {
+                return false;
+            }
+        } else if (status == JXL_DEC_PREVIEW_IMAGE) {
+            *source = JXL_PREVIEW_EMBEDDED;
+            finished = true;
+        } else if (status == JXL_DEC_NEED_IMAGE_OUT_BUFFER) {
+            size_t bufferSize;
+            if (JXL_DEC_SUCCESS != JxlDecoderImageOutBufferSize(dec.get(), &format, &bufferSize)) {
+                return false;
+            }
+            width = info.xsize;
+            height = info.ysize;
+            decoded.resize(bufferSize);
+            if (JXL_DEC_SUCCESS != JxlDecoderSetImageOutBuffer(dec.get(), &format,
+                                                               decoded.data(), decoded.size())) {
+                return false;
+            }
+        } else if (status == JXL_DEC_FRAME_PROGRESSION) {
+            // The DC is upsampled into the full resolution buffer, the resampler smooths it anyway
+            if (JXL_DEC_SUCCESS != JxlDecoderFlushImage(dec.get())) {
+                return false;
+            }
+            *source = JXL_PREVIEW_DC;
+            finished = true;
+        } else if (status == JXL_DEC_FULL_IMAGE) {
+            *source = JXL_PREVIEW_FULL_FRAME;
+            finished = true;
+        } else {
+            return false;
+        }
+    }
+
+    // Orientation is applied by the decoder, transposing ones swap the sides
+    if (info.orientation > JXL_ORIENT_ROTATE_180) {
+        std::swap(width, height);
+    }
+
+    if (static_cast<size_t>(width) * height * 4 != decoded.size()) {
+        return false;
+    }
+
+    uint32_t fitWidth = width, fitHeight = height;
+    if (maxWidth > 0 || maxHeight > 0) {
+        JxlFitSize(width, height, maxWidth > 0 ? maxWidth : width, maxHeight > 0 ? maxHeight : height,
+                   &fitWidth, &fitHeight);
+    }
+
+    if (fitWidth == width && fitHeight == height) {
+        *pixels = std::move(decoded);
+    } else {
+        pixels->resize(static_cast<size_t>(fitWidth) * fitHeight * 4);
+        JxlResamplePlan plan(width, height, fitWidth, fitHeight);
+        plan.resample(decoded.data(), width * 4, pixels->data(), fitWidth * 4, 4);
+    }
+
+    *xsize = fitWidth;
+    *ysize = fitHeight;
+    return true;
+}
+
+}
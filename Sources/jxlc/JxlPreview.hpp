@@ -0,0 +1,61 @@
+//
+//  JxlPreview.hpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#pragma once
+
+#ifdef __cplusplus
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace jxlcoder {
+
+enum JxlPreviewSource {
+    /// The preview image stored in the file header
+    JXL_PREVIEW_EMBEDDED = 1,
+    /// The 1:8 DC image of the first frame, available once its DC groups arrived
+    JXL_PREVIEW_DC = 2,
+    /// The first frame had to be decoded completely, e.g. for lossless modular files
+    JXL_PREVIEW_FULL_FRAME = 3
+};
+
+/**
+ * Decodes a small unpremultiplied RGBA8 image from the head of a JXL file.
+ * An embedded preview is used when the file has one, otherwise decoding stops at the DC of
+ * the first frame, which VarDCT and progressive DC files place before the AC data.
+ * The data may be a prefix of the file, it only has to contain the part that is needed.
+ *
+ * @param maxWidth, maxHeight bounding box of the result, the aspect ratio is kept, 0 means unlimited
+ * @param iccProfile color profile of the pixels, empty for sRGB
+ * @param source what the pixels were produced from
+ */
+bool DecodeJxlPreview(const uint8_t *jxl, size_t size, uint32_t maxWidth, uint32_t maxHeight,
+                      std::vector<uint8_t> *pixels, uint32_t *xsize, uint32_t *ysize,
+                      std::vector<uint8_t> *iccProfile, JxlPreviewSource *source);
+
+}
+
+#endif
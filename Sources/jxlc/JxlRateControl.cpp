@@ -0,0 +1,304 @@
+//
+//  JxlRateControl.cpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#include "JxlRateControl.hpp"
+#include "JxlWorker.hpp"
+#include "JxlChannelAnalysis.hpp"
+#include "concurrency.hpp"
+#include <jxl/decode.h>
+#include <jxl/decode_cxx.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <new>
+#include <thread>
+
+#include <hwy/foreach_target.h>  // IWYU pragma: keep
+#include <hwy/highway.h>
+#include "hwy/base.h"
+
+namespace jxlcoder {
+
+using namespace hwy;
+using namespace hwy::HWY_NAMESPACE;
+
+static constexpr float kRateControlMinDistance = 0.1f;
+static constexpr float kRateControlMaxDistance = 25.0f;
+// Trial encodes only have to rank distances, effort above this buys nothing for the search
+static constexpr int kRateControlTrialEffort = 3;
+// Search stops when the bracket is narrower than 2% of the distance
+static constexpr double kRateControlPrecision = 1.02;
+
+struct JxlRateTrial {
+    float distance;
+    size_t size;
+    double psnr;
+    bool succeed;
+};
+
+double ComputePSNR(const uint8_t *first, const uint8_t *second, size_t length) {
+    const ScalableTag<int16_t> di16;
+    const Rebind<uint8_t, decltype(di16)> du8;
+    const Repartition<int32_t, decltype(di16)> di32;
+    using VI32 = Vec<decltype(di32)>;
+    const size_t lanes = Lanes(di16);
+    // Keeps every int32 lane far below overflow: 2 * 4096 * 255^2 < 2^31
+    const size_t blockSize = 4096;
+
+    uint64_t squaredError = 0;
+    size_t i = 0;
+
+    while (i + lanes <= length) {
+        const size_t blockEnd = std::min(length, i + blockSize);
+        VI32 sum0 = Zero(di32);
+        VI32 sum1 = Zero(di32);
+        for (; i + lanes <= blockEnd; i += lanes) {
+            const auto a = PromoteTo(di16, LoadU(du8, first + i));
+            const auto b = PromoteTo(di16, LoadU(du8, second + i));
+            const auto diff = Sub(a, b);
+            sum0 = ReorderWidenMulAccumulate(di32, diff, diff, sum0, sum1);
+        }
+        squaredError += static_cast<uint64_t>(ReduceSum(di32, Add(sum0, sum1)));
+    }
+
+    for (; i < length; ++i) {
+        const int diff = static_cast<int>(first[i]) - static_cast<int>(second[i]);
+        squaredError += static_cast<uint64_t>(diff * diff);
+    }
+
+    if (squaredError == 0 || length == 0) {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    const double mse = static_cast<double>(squaredError) / static_cast<double>(length);
+    return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+static bool DecodeForScore(const std::vector<uint8_t> &compressed, const int components,
+                           std::vector<uint8_t> &pixels) {
+    auto dec = JxlDecoderMake(nullptr);
+    if (JXL_DEC_SUCCESS != JxlDecoderSubscribeEvents(dec.get(), JXL_DEC_FULL_IMAGE)) {
+        return false;
+    }
+
+    JxlPixelFormat format = {static_cast<uint32_t>(components), JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
+
+    JxlDecoderSetInput(dec.get(), compressed.data(), compressed.size());
+    JxlDecoderCloseInput(dec.get());
+
+    for (;;) {
+        JxlDecoderStatus status = JxlDecoderProcessInput(dec.get());
+        if (status == JXL_DEC_NEED_IMAGE_OUT_BUFFER) {
+            size_t bufferSize;
+            if (JXL_DEC_SUCCESS != JxlDecoderImageOutBufferSize(dec.get(), &format, &bufferSize)) {
+                return false;
+            }
+            if (bufferSize != pixels.size()) {
+                return false;
+            }
+            if (JXL_DEC_SUCCESS != JxlDecoderSetImageOutBuffer(dec.get(), &format,
+                                                               pixels.data(), pixels.size())) {
+                return false;
+            }
+        } else if (status == JXL_DEC_FULL_IMAGE) {
+            return true;
+        } else {
+            return false;
+        }
+    }
+}
+
+static JxlRateTrial RunTrial(const std::vector<uint8_t> &pixels, const uint32_t xsize, const uint32_t ysize,
+                             const JxlPixelType colorspace, const float distance,
+                             const int effort, const int decodingSpeed, const int numThreads,
+                             const JxlEncoderOptions &options, const JxlEncoderMetadata &metadata,
+                             const bool measurePSNR, std::vector<uint8_t> *compressed) {
+    JxlRateTrial trial = {.distance = distance, .size = 0, .psnr = -1, .succeed = false};
+    if (!EncodeJxlOneshot(pixels, xsize, ysize, compressed, colorspace, loosy,
+                          distance, effort, decodingSpeed, numThreads, options, metadata)) {
+        return trial;
+    }
+    trial.size = compressed->size();
+    if (measurePSNR) {
+        std::vector<uint8_t> decoded(pixels.size());
+        if (!DecodeForScore(*compressed, JxlPixelTypeChannels(colorspace), decoded)) {
+            return trial;
+        }
+        trial.psnr = ComputePSNR(pixels.data(), decoded.data(), pixels.size());
+    }
+    trial.succeed = true;
+    return trial;
+}
+
+static bool IsFeasible(const JxlRateTrial &trial, const JxlRateControlTarget target, const double targetValue) {
+    if (!trial.succeed) {
+        return false;
+    }
+    if (target == JXL_RATE_CONTROL_SIZE) {
+        return static_cast<double>(trial.size) <= targetValue;
+    }
+    return trial.psnr >= targetValue;
+}
+
+bool EncodeJxlRateControlled(const std::vector<uint8_t> &pixels, uint32_t xsize, uint32_t ysize,
+                             JxlPixelType colorspace, int effort, int decodingSpeed,
+                             JxlRateControlTarget target, double targetValue, int maxIterations,
+                             std::vector<uint8_t> *compressed, JxlRateControlResult *result,
+                             const JxlEncoderOptions &options,
+                             const JxlEncoderMetadata &metadata) {
+    // Effort overrides are resolved here, trials must stay free to lower the effort
+    if (options.effort >= 0) {
+        effort = options.effort;
+    }
+    if (options.decodingSpeed >= 0) {
+        decodingSpeed = options.decodingSpeed;
+    }
+    JxlEncoderOptions encodeOptions = options;
+    encodeOptions.effort = -1;
+    encodeOptions.decodingSpeed = -1;
+
+    const bool measurePSNR = target == JXL_RATE_CONTROL_PSNR;
+    const int hardwareThreads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+    const int probesCount = std::clamp(hardwareThreads, 2, 8);
+    const int threadsPerProbe = std::max(hardwareThreads / probesCount, 1);
+    const int trialEffort = std::min(effort, kRateControlTrialEffort);
+
+    // Size shrinks and PSNR drops monotonically with distance, so a byte budget is satisfied by
+    // every distance above some threshold and a score by every distance below one
+    double lo = std::log(kRateControlMinDistance);
+    double hi = std::log(kRateControlMaxDistance);
+    float bestDistance = target == JXL_RATE_CONTROL_SIZE ? kRateControlMaxDistance : kRateControlMinDistance;
+    bool haveFeasible = false;
+    int iterations = 0;
+
+    std::vector<JxlRateTrial> trials(probesCount);
+    std::vector<std::vector<uint8_t>> trialBuffers(probesCount);
+
+    while (iterations < maxIterations && std::exp(hi - lo) > kRateControlPrecision) {
+        iterations += 1;
+
+        std::vector<double> positions(probesCount);
+        for (int i = 0; i < probesCount; ++i) {
+            positions[i] = lo + (hi - lo) * static_cast<double>(i + 1) / static_cast<double>(probesCount + 1);
+        }
+
+        concurrency::parallel_for(probesCount, probesCount, [&](int i) {
+            // Exceptions can't leave a worker thread, running out of memory fails the probe instead
+            try {
+                trials[i] = RunTrial(pixels, xsize, ysize, colorspace,
+                                     static_cast<float>(std::exp(positions[i])),
+                                     trialEffort, decodingSpeed, threadsPerProbe, encodeOptions, metadata,
+                                     measurePSNR, &trialBuffers[i]);
+            } catch (std::bad_alloc &err) {
+                trials[i].succeed = false;
+            }
+        });
+
+        for (const auto &trial: trials) {
+            if (!trial.succeed) {
+                return false;
+            }
+        }
+
+        if (target == JXL_RATE_CONTROL_SIZE) {
+            int firstFeasible = -1;
+            for (int i = 0; i < probesCount; ++i) {
+                if (IsFeasible(trials[i], target, targetValue)) {
+                    firstFeasible = i;
+                    break;
+                }
+            }
+            if (firstFeasible >= 0) {
+                if (!haveFeasible || trials[firstFeasible].distance < bestDistance) {
+                    bestDistance = trials[firstFeasible].distance;
+                }
+                haveFeasible = true;
+                hi = positions[firstFeasible];
+                lo = firstFeasible > 0 ? positions[firstFeasible - 1] : lo;
+            } else {
+                lo = positions[probesCount - 1];
+            }
+        } else {
+            int lastFeasible = -1;
+            for (int i = probesCount - 1; i >= 0; --i) {
+                if (IsFeasible(trials[i], target, targetValue)) {
+                    lastFeasible = i;
+                    break;
+                }
+            }
+            if (lastFeasible >= 0) {
+                if (!haveFeasible || trials[lastFeasible].distance > bestDistance) {
+                    bestDistance = trials[lastFeasible].distance;
+                }
+                haveFeasible = true;
+                lo = positions[lastFeasible];
+                hi = lastFeasible + 1 < probesCount ? positions[lastFeasible + 1] : hi;
+            } else {
+                hi = positions[0];
+            }
+        }
+    }
+
+    trialBuffers.clear();
+
+    // Trials ran at low effort, the requested effort usually lands slightly off,
+    // remaining iterations are spent on nudging the distance back over the target
+    JxlRateTrial finalTrial = RunTrial(pixels, xsize, ysize, colorspace, bestDistance,
+                                  effort, decodingSpeed, 0, encodeOptions, metadata, measurePSNR, compressed);
+    if (!finalTrial.succeed) {
+        return false;
+    }
+
+    while (iterations < maxIterations && !IsFeasible(finalTrial, target, targetValue)) {
+        float nextDistance;
+        if (target == JXL_RATE_CONTROL_SIZE) {
+            const double overshoot = static_cast<double>(finalTrial.size) / std::max(targetValue, 1.0);
+            nextDistance = std::min(finalTrial.distance * static_cast<float>(std::clamp(overshoot, 1.05, 2.0)),
+                                    kRateControlMaxDistance);
+        } else {
+            nextDistance = std::max(finalTrial.distance / 1.1f, kRateControlMinDistance);
+        }
+        if (nextDistance == finalTrial.distance) {
+            break;
+        }
+        iterations += 1;
+        finalTrial = RunTrial(pixels, xsize, ysize, colorspace, nextDistance,
+                         effort, decodingSpeed, 0, encodeOptions, metadata, measurePSNR, compressed);
+        if (!finalTrial.succeed) {
+            return false;
+        }
+    }
+
+    if (result) {
+        result->distance = finalTrial.distance;
+        result->size = finalTrial.size;
+        result->psnr = finalTrial.psnr;
+        result->iterations = iterations;
+    }
+
+    return true;
+}
+
+}
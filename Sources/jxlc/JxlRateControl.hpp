@@ -0,0 +1,83 @@
+//
+//  JxlRateControl.hpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#pragma once
+
+#ifdef __cplusplus
+
+#include <cstdint>
+#include <vector>
+#include "JxlDefinitions.h"
+#include "JxlEncoderOptions.hpp"
+#include "JxlEncoderMetadata.hpp"
+
+namespace jxlcoder {
+
+enum JxlRateControlTarget {
+    /// Largest quality that fits into the byte budget
+    JXL_RATE_CONTROL_SIZE = 1,
+    /// Smallest file that reaches the PSNR score in dB
+    JXL_RATE_CONTROL_PSNR = 2
+};
+
+struct JxlRateControlResult {
+    /// Butteraugli distance used for the final encode
+    float distance;
+    /// Size of the final encode in bytes
+    size_t size;
+    /// PSNR of the final encode in dB, measured only for JXL_RATE_CONTROL_PSNR, otherwise -1
+    double psnr;
+    /// Rounds of trial encodes that were spent, final corrections included
+    int iterations;
+};
+
+/**
+ * Searches the lossy distance that satisfies the target and encodes the image with it.
+ * Every round encodes several candidate distances in parallel at low effort and narrows
+ * the bracket around the target, the final encode runs at the requested effort.
+ *
+ * @param pixels interleaved 8-bit pixels in the layout of colorspace
+ * @param target what targetValue means: a byte budget or a PSNR score
+ * @param maxIterations upper bound of search rounds
+ * @param compressed will be populated with the compressed bytes
+ * @param result achieved distance, size and score
+ * @param options frame settings applied to every trial, its effort override replaces effort
+ * @param metadata ICC profile and boxes, they are part of every trial so a byte budget accounts for them
+ */
+bool EncodeJxlRateControlled(const std::vector<uint8_t> &pixels, uint32_t xsize, uint32_t ysize,
+                             JxlPixelType colorspace, int effort, int decodingSpeed,
+                             JxlRateControlTarget target, double targetValue, int maxIterations,
+                             std::vector<uint8_t> *compressed, JxlRateControlResult *result,
+                             const JxlEncoderOptions &options = JxlEncoderOptions(),
+                             const JxlEncoderMetadata &metadata = JxlEncoderMetadata());
+
+/**
+ * @return PSNR in dB between two 8-bit buffers of the same layout, infinity when they are equal
+ */
+double ComputePSNR(const uint8_t *first, const uint8_t *second, size_t length);
+
+}
+
+#endif
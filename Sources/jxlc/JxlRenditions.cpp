@@ -0,0 +1,215 @@
+//
+//  JxlRenditions.cpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#include "JxlRenditions.hpp"
+#include "JxlBatchEncoder.hpp"
+#include "JxlChannelAnalysis.hpp"
+#include "JxlResampler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include "concurrency.hpp"
+
+#include <hwy/foreach_target.h>  // IWYU pragma: keep
+#include <hwy/highway.h>
+#include "hwy/base.h"
+
+namespace jxlcoder {
+
+using namespace hwy;
+using namespace hwy::HWY_NAMESPACE;
+
+/**
+ * Averages horizontal pairs of pixels of a row that is already the vertical average,
+ * pixels of 1, 2 and 4 bytes are split into even and odd ones as whole lanes
+ */
+template<class T>
+static uint32_t JxlHalveRowLanes(const uint8_t *__restrict__ row, uint8_t *__restrict__ dst, const uint32_t dstWidth) {
+    const ScalableTag<T> dt;
+    const Repartition<uint8_t, decltype(dt)> du8;
+    const size_t lanes = Lanes(dt);
+    auto src = reinterpret_cast<const T *>(row);
+    auto out = reinterpret_cast<T *>(dst);
+    uint32_t x = 0;
+    for (; x + lanes <= dstWidth; x += lanes) {
+        const auto first = LoadU(dt, src + x * 2);
+        const auto second = LoadU(dt, src + x * 2 + lanes);
+        const auto even = BitCast(du8, ConcatEven(dt, second, first));
+        const auto odd = BitCast(du8, ConcatOdd(dt, second, first));
+        StoreU(BitCast(dt, AverageRound(even, odd)), dt, out + x);
+    }
+    return x;
+}
+
+void JxlDownscaleHalf(const uint8_t *src, uint32_t srcStride, uint32_t width, uint32_t height,
+                      uint8_t *dst, uint32_t dstStride, int channels) {
+    const uint32_t dstWidth = width / 2;
+    const uint32_t dstHeight = height / 2;
+    const size_t rowLength = static_cast<size_t>(dstWidth) * 2 * channels;
+
+    const int threads = static_cast<int>(std::clamp<uint64_t>(static_cast<uint64_t>(width) * height / (512 * 512), 1,
+                                                              std::max(std::thread::hardware_concurrency(), 1u)));
+    std::vector<std::vector<uint8_t>> scratch(threads, std::vector<uint8_t>(rowLength + 64));
+
+    concurrency::parallel_for_with_thread_id(threads, static_cast<int>(dstHeight), [&](int threadId, int y) {
+        const ScalableTag<uint8_t> du8;
+        const size_t lanes = Lanes(du8);
+        const uint8_t *top = src + static_cast<size_t>(y) * 2 * srcStride;
+        const uint8_t *bottom = top + srcStride;
+        uint8_t *row = scratch[threadId].data();
+        uint8_t *out = dst + static_cast<size_t>(y) * dstStride;
+
+        size_t i = 0;
+        for (; i + lanes <= rowLength; i += lanes) {
+            StoreU(AverageRound(LoadU(du8, top + i), LoadU(du8, bottom + i)), du8, row + i);
+        }
+        for (; i < rowLength; ++i) {
+            row[i] = static_cast<uint8_t>((top[i] + bottom[i] + 1) >> 1);
+        }
+
+        uint32_t x = 0;
+        if (channels == 4) {
+            x = JxlHalveRowLanes<uint32_t>(row, out, dstWidth);
+        } else if (channels == 2) {
+            x = JxlHalveRowLanes<uint16_t>(row, out, dstWidth);
+        } else if (channels == 1) {
+            x = JxlHalveRowLanes<uint8_t>(row, out, dstWidth);
+        }
+        for (; x < dstWidth; ++x) {
+            for (int c = 0; c < channels; ++c) {
+                out[x * channels + c] = static_cast<uint8_t>((row[x * 2 * channels + c] +
+                                                              row[(x * 2 + 1) * channels + c] + 1) >> 1);
+            }
+        }
+    });
+}
+
+struct JxlPyramidLevel {
+    uint32_t width;
+    uint32_t height;
+    std::vector<uint8_t> pixels;
+};
+
+bool EncodeJxlRenditions(const std::vector<uint8_t> &pixels, uint32_t xsize, uint32_t ysize,
+                         JxlPixelType colorspace, const std::vector<JxlRenditionTarget> &targets,
+                         int decodingSpeed, const JxlEncoderOptions &options,
+                         std::vector<JxlRendition> *renditions, int coreBudget,
+                         const JxlEncoderMetadata &metadata) {
+    using Clock = std::chrono::steady_clock;
+    const int channels = JxlPixelTypeChannels(colorspace);
+    renditions->clear();
+    renditions->resize(targets.size());
+    if (targets.empty()) {
+        return true;
+    }
+
+    for (size_t i = 0; i < targets.size(); ++i) {
+        JxlRendition &rendition = (*renditions)[i];
+        rendition.width = std::clamp<uint32_t>(targets[i].width, 1, xsize);
+        rendition.height = std::max<uint32_t>(static_cast<uint32_t>(std::lround(
+                static_cast<double>(ysize) * rendition.width / xsize)), 1);
+    }
+
+    uint32_t smallestWidth = xsize;
+    for (const auto &rendition: *renditions) {
+        smallestWidth = std::min(smallestWidth, rendition.width);
+    }
+
+    // Level 0 is the source itself, the pyramid stops before it would drop below the smallest rendition
+    std::vector<JxlPyramidLevel> levels;
+    uint32_t levelWidth = xsize, levelHeight = ysize;
+    const uint8_t *levelPixels = pixels.data();
+    while (levelWidth / 2 >= smallestWidth && levelHeight / 2 >= 1) {
+        JxlPyramidLevel level;
+        level.width = levelWidth / 2;
+        level.height = levelHeight / 2;
+        level.pixels.resize(static_cast<size_t>(level.width) * level.height * channels);
+        JxlDownscaleHalf(levelPixels, levelWidth * channels, levelWidth, levelHeight,
+                         level.pixels.data(), level.width * channels, channels);
+        levels.push_back(std::move(level));
+        levelWidth = levels.back().width;
+        levelHeight = levels.back().height;
+        levelPixels = levels.back().pixels.data();
+    }
+
+    std::vector<JxlBatchJob> jobs(targets.size());
+
+    concurrency::parallel_for(std::min<int>(static_cast<int>(targets.size()),
+                                            std::max(static_cast<int>(std::thread::hardware_concurrency()), 1)),
+                              static_cast<int>(targets.size()), [&](int i) {
+        JxlRendition &rendition = (*renditions)[i];
+        JxlBatchJob &job = jobs[i];
+        const auto start = Clock::now();
+
+        // The smallest level that is still at least as large as the rendition, at most a 2x reduction remains
+        const uint8_t *source = pixels.data();
+        uint32_t sourceWidth = xsize, sourceHeight = ysize;
+        for (const auto &level: levels) {
+            if (level.width < rendition.width || level.height < rendition.height) {
+                break;
+            }
+            source = level.pixels.data();
+            sourceWidth = level.width;
+            sourceHeight = level.height;
+        }
+
+        job.pixels.resize(static_cast<size_t>(rendition.width) * rendition.height * channels);
+        if (sourceWidth == rendition.width && sourceHeight == rendition.height) {
+            std::copy(source, source + job.pixels.size(), job.pixels.begin());
+        } else {
+            JxlResamplePlan plan(sourceWidth, sourceHeight, rendition.width, rendition.height);
+            plan.resample(source, sourceWidth * channels, job.pixels.data(), rendition.width * channels, channels, 1);
+        }
+
+        job.xsize = rendition.width;
+        job.ysize = rendition.height;
+        job.colorspace = colorspace;
+        job.compressionOption = loosy;
+        job.distance = targets[i].distance;
+        job.effort = targets[i].effort;
+        job.decodingSpeed = decodingSpeed;
+        job.options = options;
+        job.metadata = metadata;
+        rendition.resampleTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    });
+
+    levels.clear();
+
+    JxlBatchEncoder encoder(coreBudget);
+    auto results = encoder.encode(jobs);
+
+    bool succeed = true;
+    for (size_t i = 0; i < results.size(); ++i) {
+        JxlRendition &rendition = (*renditions)[i];
+        rendition.succeed = results[i].succeed;
+        rendition.encodeTime = results[i].encodeTime;
+        rendition.compressed = std::move(results[i].compressed);
+        succeed = succeed && rendition.succeed;
+    }
+    return succeed;
+}
+
+}
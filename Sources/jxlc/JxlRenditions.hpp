@@ -0,0 +1,81 @@
+//
+//  JxlRenditions.hpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#pragma once
+
+#ifdef __cplusplus
+
+#include <cstdint>
+#include <vector>
+#include "JxlDefinitions.h"
+#include "JxlEncoderOptions.hpp"
+#include "JxlEncoderMetadata.hpp"
+
+namespace jxlcoder {
+
+struct JxlRenditionTarget {
+    /// Width of the rendition, the height follows the aspect ratio, never larger than the source
+    uint32_t width;
+    float distance;
+    int effort;
+};
+
+struct JxlRendition {
+    bool succeed = false;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> compressed;
+    /// Time spent on resampling from the pyramid level, in milliseconds
+    double resampleTime = 0;
+    /// Time the encoder spent on the rendition, in milliseconds
+    double encodeTime = 0;
+};
+
+/**
+ * Encodes one source at several sizes.
+ * A 2x box pyramid is built once and every rendition is resampled from the closest larger level,
+ * then all renditions are encoded concurrently within one core budget.
+ *
+ * @param pixels interleaved 8-bit pixels in the layout of colorspace
+ * @param renditions one entry per target in the same order
+ * @param coreBudget threads the encodes may occupy, 0 means one per core
+ * @param metadata ICC profile and boxes written into every rendition
+ * @return true when every rendition was encoded
+ */
+bool EncodeJxlRenditions(const std::vector<uint8_t> &pixels, uint32_t xsize, uint32_t ysize,
+                         JxlPixelType colorspace, const std::vector<JxlRenditionTarget> &targets,
+                         int decodingSpeed, const JxlEncoderOptions &options,
+                         std::vector<JxlRendition> *renditions, int coreBudget = 0,
+                         const JxlEncoderMetadata &metadata = JxlEncoderMetadata());
+
+/**
+ * Halves the image in both directions averaging every 2x2 block, odd trailing rows and columns are dropped
+ */
+void JxlDownscaleHalf(const uint8_t *src, uint32_t srcStride, uint32_t width, uint32_t height,
+                      uint8_t *dst, uint32_t dstStride, int channels);
+
+}
+
+#endif
@@ -0,0 +1,243 @@
+//
+//  JxlResampler.cpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#include "JxlResampler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include "concurrency.hpp"
+
+#include <hwy/foreach_target.h>  // IWYU pragma: keep
+#include <hwy/highway.h>
+#include "hwy/base.h"
+#include "sampler-inl.h"
+
+namespace jxlcoder {
+
+using namespace hwy;
+using namespace hwy::HWY_NAMESPACE;
+
+static float JxlFilterRadius(const JxlResamplingFilter filter) {
+    switch (filter) {
+        case JXL_RESAMPLING_BILINEAR:
+            return 1.0f;
+        case JXL_RESAMPLING_CATMULL_ROM:
+        case JXL_RESAMPLING_MITCHELL:
+            return 2.0f;
+        case JXL_RESAMPLING_LANCZOS3:
+            return 3.0f;
+    }
+    return 1.0f;
+}
+
+/**
+ * Evaluates the filter over distances in place, the length must be a multiple of the vector lanes
+ */
+static void JxlEvaluateFilter(float *__restrict__ values, const size_t length, const JxlResamplingFilter filter) {
+    const ScalableTag<float> df;
+    using VF = Vec<decltype(df)>;
+    const size_t lanes = Lanes(df);
+    const VF zeros = Zero(df);
+    const VF ones = Set(df, 1.0f);
+    const VF lanczosA = Set(df, 3.0f);
+    const VF catmullB = Zero(df);
+    const VF catmullC = Set(df, 0.5f);
+    for (size_t i = 0; i < length; i += lanes) {
+        VF x = LoadU(df, values + i);
+        VF weight;
+        switch (filter) {
+            case JXL_RESAMPLING_BILINEAR:
+                weight = Max(Sub(ones, Abs(x)), zeros);
+                break;
+            case JXL_RESAMPLING_CATMULL_ROM:
+                weight = BCSpline(df, x, catmullB, catmullC);
+                break;
+            case JXL_RESAMPLING_MITCHELL:
+                weight = MitchellNetravaliV(df, x);
+                break;
+            case JXL_RESAMPLING_LANCZOS3:
+                weight = LanczosWindowHWY(df, x, lanczosA);
+                break;
+        }
+        StoreU(weight, df, values + i);
+    }
+}
+
+JxlResamplePlan::Axis JxlResamplePlan::makeAxis(uint32_t srcSize, uint32_t dstSize, JxlResamplingFilter filter) {
+    Axis axis;
+    const double scale = static_cast<double>(srcSize) / static_cast<double>(dstSize);
+    // Downscaling stretches the kernel over the source so every source sample contributes
+    const double filterScale = std::max(scale, 1.0);
+    const double support = JxlFilterRadius(filter) * filterScale;
+    axis.taps = static_cast<int>(std::ceil(support * 2.0)) + 1;
+
+    const ScalableTag<float> df;
+    const size_t count = static_cast<size_t>(dstSize) * axis.taps;
+    const size_t padded = (count + Lanes(df) - 1) / Lanes(df) * Lanes(df);
+    axis.indices.resize(count);
+    axis.weights.resize(padded, 0.0f);
+
+    for (uint32_t i = 0; i < dstSize; ++i) {
+        const double center = (static_cast<double>(i) + 0.5) * scale - 0.5;
+        const int start = static_cast<int>(std::floor(center - support)) + 1;
+        for (int k = 0; k < axis.taps; ++k) {
+            const int position = start + k;
+            axis.weights[i * axis.taps + k] = static_cast<float>((position - center) / filterScale);
+            axis.indices[i * axis.taps + k] = std::clamp(position, 0, static_cast<int>(srcSize) - 1);
+        }
+    }
+
+    JxlEvaluateFilter(axis.weights.data(), padded, filter);
+    axis.weights.resize(count);
+
+    for (uint32_t i = 0; i < dstSize; ++i) {
+        float *weights = axis.weights.data() + i * axis.taps;
+        float sum = 0.0f;
+        for (int k = 0; k < axis.taps; ++k) {
+            sum += weights[k];
+        }
+        if (std::fabs(sum) < 1e-6f) {
+            std::fill(weights, weights + axis.taps, 0.0f);
+            weights[axis.taps / 2] = 1.0f;
+            continue;
+        }
+        const float norm = 1.0f / sum;
+        for (int k = 0; k < axis.taps; ++k) {
+            weights[k] *= norm;
+        }
+    }
+    return axis;
+}
+
+JxlResamplePlan::JxlResamplePlan(uint32_t srcWidth, uint32_t srcHeight, uint32_t dstWidth, uint32_t dstHeight,
+                                 JxlResamplingFilter filter) : srcWidth(srcWidth), srcHeight(srcHeight),
+                                                               dstWidth(dstWidth), dstHeight(dstHeight) {
+    horizontal = makeAxis(srcWidth, dstWidth, filter);
+    vertical = makeAxis(srcHeight, dstHeight, filter);
+}
+
+/**
+ * Accumulates the weighted source rows of one destination row, all channels at once
+ */
+static void JxlResampleColumn(const uint8_t *__restrict__ src, const uint32_t srcStride,
+                              const int32_t *__restrict__ indices, const float *__restrict__ weights,
+                              const int taps, float *__restrict__ row, const size_t length) {
+    const ScalableTag<float> df;
+    const Rebind<int32_t, decltype(df)> di;
+    const Rebind<uint8_t, decltype(df)> du8;
+    using VF = Vec<decltype(df)>;
+    const size_t lanes = Lanes(df);
+
+    std::fill(row, row + length, 0.0f);
+
+    for (int k = 0; k < taps; ++k) {
+        const float weight = weights[k];
+        if (weight == 0.0f) {
+            continue;
+        }
+        const uint8_t *srcRow = src + static_cast<size_t>(indices[k]) * srcStride;
+        const VF vWeight = Set(df, weight);
+        size_t x = 0;
+        for (; x + lanes <= length; x += lanes) {
+            const VF pixels = ConvertTo(df, PromoteTo(di, LoadU(du8, srcRow + x)));
+            StoreU(MulAdd(pixels, vWeight, LoadU(df, row + x)), df, row + x);
+        }
+        for (; x < length; ++x) {
+            row[x] += static_cast<float>(srcRow[x]) * weight;
+        }
+    }
+}
+
+/**
+ * Filters one accumulated row horizontally, RGBA is kept in a single four lane vector
+ */
+static void JxlResampleRow(const float *__restrict__ row, const int32_t *__restrict__ indices,
+                           const float *__restrict__ weights, const int taps,
+                           uint8_t *__restrict__ dst, const uint32_t dstWidth, const int channels) {
+    if (channels == 4) {
+        const FixedTag<float, 4> df;
+        const Rebind<uint8_t, decltype(df)> du8;
+        using VF = Vec<decltype(df)>;
+        const VF zeros = Zero(df);
+        const VF maxColors = Set(df, 255.0f);
+        for (uint32_t x = 0; x < dstWidth; ++x) {
+            const int32_t *pixelIndices = indices + static_cast<size_t>(x) * taps;
+            const float *pixelWeights = weights + static_cast<size_t>(x) * taps;
+            VF acc = Zero(df);
+            for (int k = 0; k < taps; ++k) {
+                acc = MulAdd(LoadU(df, row + pixelIndices[k] * 4), Set(df, pixelWeights[k]), acc);
+            }
+            acc = Min(Max(acc, zeros), maxColors);
+            StoreU(DemoteTo(du8, NearestInt(acc)), du8, dst + x * 4);
+        }
+        return;
+    }
+
+    for (uint32_t x = 0; x < dstWidth; ++x) {
+        const int32_t *pixelIndices = indices + static_cast<size_t>(x) * taps;
+        const float *pixelWeights = weights + static_cast<size_t>(x) * taps;
+        for (int c = 0; c < channels; ++c) {
+            float acc = 0.0f;
+            for (int k = 0; k < taps; ++k) {
+                acc += row[pixelIndices[k] * channels + c] * pixelWeights[k];
+            }
+            dst[x * channels + c] = static_cast<uint8_t>(std::clamp(std::lround(acc), 0L, 255L));
+        }
+    }
+}
+
+void JxlResamplePlan::resample(const uint8_t *src, uint32_t srcStride, uint8_t *dst, uint32_t dstStride,
+                               int channels, int numThreads) const {
+    if (numThreads <= 0) {
+        const uint64_t work = static_cast<uint64_t>(srcWidth) * dstHeight * vertical.taps;
+        numThreads = static_cast<int>(std::clamp<uint64_t>(work / (512 * 512), 1,
+                                                           std::max(std::thread::hardware_concurrency(), 1u)));
+    }
+    numThreads = std::clamp(numThreads, 1, static_cast<int>(std::max<uint32_t>(dstHeight, 1)));
+
+    const size_t rowLength = static_cast<size_t>(srcWidth) * channels;
+    std::vector<std::vector<float>> scratch(numThreads, std::vector<float>(rowLength));
+
+    concurrency::parallel_for_with_thread_id(numThreads, static_cast<int>(dstHeight), [&](int threadId, int y) {
+        float *row = scratch[threadId].data();
+        JxlResampleColumn(src, srcStride,
+                          vertical.indices.data() + static_cast<size_t>(y) * vertical.taps,
+                          vertical.weights.data() + static_cast<size_t>(y) * vertical.taps,
+                          vertical.taps, row, rowLength);
+        JxlResampleRow(row, horizontal.indices.data(), horizontal.weights.data(), horizontal.taps,
+                       dst + static_cast<size_t>(y) * dstStride, dstWidth, channels);
+    });
+}
+
+void JxlFitSize(uint32_t width, uint32_t height, uint32_t maxWidth, uint32_t maxHeight,
+                uint32_t *fitWidth, uint32_t *fitHeight) {
+    const double scale = std::min({1.0,
+                                   static_cast<double>(maxWidth) / std::max<uint32_t>(width, 1),
+                                   static_cast<double>(maxHeight) / std::max<uint32_t>(height, 1)});
+    *fitWidth = std::max<uint32_t>(static_cast<uint32_t>(std::lround(width * scale)), 1);
+    *fitHeight = std::max<uint32_t>(static_cast<uint32_t>(std::lround(height * scale)), 1);
+}
+
+}
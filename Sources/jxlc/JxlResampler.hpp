@@ -0,0 +1,93 @@
+//
+//  JxlResampler.hpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#pragma once
+
+#ifdef __cplusplus
+
+#include <cstdint>
+#include <vector>
+
+namespace jxlcoder {
+
+enum JxlResamplingFilter {
+    JXL_RESAMPLING_BILINEAR = 1,
+    JXL_RESAMPLING_CATMULL_ROM = 2,
+    JXL_RESAMPLING_MITCHELL = 3,
+    JXL_RESAMPLING_LANCZOS3 = 4
+};
+
+/**
+ * Separable resampling between two fixed image sizes.
+ * Filter taps and weights are computed once with the SIMD kernels of algo/sampler-inl.h,
+ * so a plan can be reused for every frame or rendition that shares the same dimensions.
+ * The plan is immutable after construction and can be used from several threads at once.
+ */
+class JxlResamplePlan {
+public:
+    JxlResamplePlan(uint32_t srcWidth, uint32_t srcHeight, uint32_t dstWidth, uint32_t dstHeight,
+                    JxlResamplingFilter filter = JXL_RESAMPLING_LANCZOS3);
+
+    /**
+     * Resamples interleaved 8-bit pixels, rows are processed in parallel
+     * @param channels 1...4
+     * @param numThreads 0 picks the count from the image size, 1 runs on the calling thread
+     */
+    void resample(const uint8_t *src, uint32_t srcStride, uint8_t *dst, uint32_t dstStride,
+                  int channels, int numThreads = 0) const;
+
+    uint32_t getSourceWidth() const { return srcWidth; }
+    uint32_t getSourceHeight() const { return srcHeight; }
+    uint32_t getDestinationWidth() const { return dstWidth; }
+    uint32_t getDestinationHeight() const { return dstHeight; }
+
+private:
+    struct Axis {
+        int taps;
+        /// taps source indices per destination sample, already clamped to the image
+        std::vector<int32_t> indices;
+        /// taps normalized weights per destination sample
+        std::vector<float> weights;
+    };
+
+    static Axis makeAxis(uint32_t srcSize, uint32_t dstSize, JxlResamplingFilter filter);
+
+    uint32_t srcWidth;
+    uint32_t srcHeight;
+    uint32_t dstWidth;
+    uint32_t dstHeight;
+    Axis horizontal;
+    Axis vertical;
+};
+
+/**
+ * @return size fitting into maxWidth x maxHeight with the aspect ratio kept, never larger than the source
+ */
+void JxlFitSize(uint32_t width, uint32_t height, uint32_t maxWidth, uint32_t maxHeight,
+                uint32_t *fitWidth, uint32_t *fitHeight);
+
+}
+
+#endif
@@ -31,22 +31,86 @@
 #include "jxl/encode_cxx.h"
 #include "jxl/thread_parallel_runner.h"
 #include "jxl/thread_parallel_runner_cxx.h"
+#include <algorithm>
 #include <vector>
+#include "JxlEncoderOptions.hpp"
 
 namespace jxlcoder {
-class JxlConstruction {
+
+/**
+ * Lossless JPEG recompression that keeps one libjxl encoder and its thread pool alive,
+ * so transcoding many files only resets the encoder between them
+ */
+class JxlJpegTranscoder {
  public:
-  JxlConstruction(std::vector<uint8_t> &data) : jpegData(data) {
+  /**
+   * @param numThreads 0 means one per core, 1 encodes on the calling thread only
+   */
+  explicit JxlJpegTranscoder(int numThreads = 0) : enc(JxlEncoderMake(nullptr)) {
+    if (numThreads <= 0) {
+      numThreads = static_cast<int>(JxlThreadParallelRunnerDefaultNumWorkerThreads());
+    }
+    if (numThreads > 1) {
+      runner = JxlThreadParallelRunnerMake(nullptr, numThreads);
+    }
+  }
+
+  /**
+   * Transcodes into memory
+   */
+  bool transcode(const uint8_t *jpeg, size_t size, std::vector<uint8_t> &compressed,
+                 int effort = 7, int decodingSpeed = 3,
+                 const JxlEncoderOptions &options = JxlEncoderOptions()) {
+    if (!addJpeg(jpeg, size, effort, decodingSpeed, options)) {
+      return false;
+    }
+
+    compressed.resize(std::max<size_t>(64, size / 2));
+    uint8_t *next_out = compressed.data();
+    size_t avail_out = compressed.size() - (next_out - compressed.data());
+    JxlEncoderStatus process_result = JXL_ENC_NEED_MORE_OUTPUT;
+    while (process_result == JXL_ENC_NEED_MORE_OUTPUT) {
+      process_result = JxlEncoderProcessOutput(enc.get(), &next_out, &avail_out);
+      if (process_result == JXL_ENC_NEED_MORE_OUTPUT) {
+        size_t offset = next_out - compressed.data();
+        compressed.resize(compressed.size() * 2);
+        next_out = compressed.data() + offset;
+        avail_out = compressed.size() - offset;
+      }
+    }
+    compressed.resize(next_out - compressed.data());
+    return JXL_ENC_SUCCESS == process_result;
+  }
 
+  /**
+   * Transcodes straight into the output processor, the encoded stream is never held in memory at once
+   */
+  bool transcode(const uint8_t *jpeg, size_t size, const JxlEncoderOutputProcessor &processor,
+                 int effort = 7, int decodingSpeed = 3,
+                 const JxlEncoderOptions &options = JxlEncoderOptions()) {
+    JxlEncoderReset(enc.get());
+    if (JXL_ENC_SUCCESS != JxlEncoderSetOutputProcessor(enc.get(), processor)) {
+      return false;
+    }
+    if (!addJpeg(jpeg, size, effort, decodingSpeed, options, false)) {
+      return false;
+    }
+    return JXL_ENC_SUCCESS == JxlEncoderFlushInput(enc.get());
   }
 
-  bool construct() {
-    auto enc = JxlEncoderMake(nullptr);
-    auto runner = JxlThreadParallelRunnerMake(nullptr,
-                                              JxlThreadParallelRunnerDefaultNumWorkerThreads());
-    if (JXL_ENC_SUCCESS != JxlEncoderSetParallelRunner(enc.get(),
-                                                       JxlThreadParallelRunner,
-                                                       runner.get())) {
+ private:
+  bool addJpeg(const uint8_t *jpeg, size_t size, int effort, int decodingSpeed,
+               const JxlEncoderOptions &options, bool reset = true) {
+    if (!enc) {
+      return false;
+    }
+    if (reset) {
+      JxlEncoderReset(enc.get());
+    }
+    // Reset drops every setting, the runner included
+    if (runner && JXL_ENC_SUCCESS != JxlEncoderSetParallelRunner(enc.get(),
+                                                                 JxlThreadParallelRunner,
+                                                                 runner.get())) {
       return false;
     }
 
@@ -54,6 +118,10 @@ class JxlConstruction {
       return false;
     }
 
+    if (!ApplyCodestreamLevel(enc.get(), options)) {
+      return false;
+    }
+
     JxlEncoderFrameSettings *frameSettings =
         JxlEncoderFrameSettingsCreate(enc.get(), nullptr);
 
@@ -62,49 +130,53 @@ class JxlConstruction {
     }
 
     if (JxlEncoderFrameSettingsSetOption(frameSettings,
-                                         JXL_ENC_FRAME_SETTING_EFFORT, 7) != JXL_ENC_SUCCESS) {
+                                         JXL_ENC_FRAME_SETTING_EFFORT, effort) != JXL_ENC_SUCCESS) {
       return false;
     }
 
     if (JXL_ENC_SUCCESS !=
-        JxlEncoderFrameSettingsSetOption(frameSettings, JXL_ENC_FRAME_SETTING_DECODING_SPEED, 3)) {
+        JxlEncoderFrameSettingsSetOption(frameSettings, JXL_ENC_FRAME_SETTING_DECODING_SPEED, decodingSpeed)) {
       return false;
     }
 
-    if (JXL_ENC_SUCCESS !=
-        JxlEncoderAddJPEGFrame(frameSettings, jpegData.data(), jpegData.size())) {
+    if (!ApplyFrameOptions(frameSettings, options)) {
       return false;
     }
 
-    JxlEncoderCloseInput(enc.get());
-
-    compressed.resize(64);
-    uint8_t *next_out = compressed.data();
-    size_t avail_out = compressed.size() - (next_out - compressed.data());
-    JxlEncoderStatus process_result = JXL_ENC_NEED_MORE_OUTPUT;
-    while (process_result == JXL_ENC_NEED_MORE_OUTPUT) {
-      process_result = JxlEncoderProcessOutput(enc.get(), &next_out, &avail_out);
-      if (process_result == JXL_ENC_NEED_MORE_OUTPUT) {
-        size_t offset = next_out - compressed.data();
-        compressed.resize(compressed.size() * 2);
-        next_out = compressed.data() + offset;
-        avail_out = compressed.size() - offset;
-      }
-    }
-    compressed.resize(next_out - compressed.data());
-    if (JXL_ENC_SUCCESS != process_result) {
+    if (JXL_ENC_SUCCESS !=
+        JxlEncoderAddJPEGFrame(frameSettings, jpeg, size)) {
       return false;
     }
 
+    JxlEncoderCloseInput(enc.get());
     return true;
   }
 
+  JxlEncoderPtr enc;
+  JxlThreadParallelRunnerPtr runner;
+};
+
+class JxlConstruction {
+ public:
+  JxlConstruction(std::vector<uint8_t> &data,
+                  const JxlEncoderOptions &options = JxlEncoderOptions(),
+                  int effort = 7) : jpegData(data), options(options), effort(effort) {
+
+  }
+
+  bool construct() {
+    JxlJpegTranscoder transcoder;
+    return transcoder.transcode(jpegData.data(), jpegData.size(), compressed, effort, 3, options);
+  }
+
   std::vector<uint8_t> &getCompressedData() {
     return compressed;
   }
 
  private:
   const std::vector<uint8_t> jpegData;
+  const JxlEncoderOptions options;
+  const int effort;
   std::vector<uint8_t> compressed;
 };
 }
@@ -68,7 +68,8 @@ bool DecodeJpegXlOneShot(const uint8_t *jxl, size_t size,
     if (pixelFormat == optimal) {
         format = {4, JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
     } else {
-        if (pixelFormat == float16) {
+        // Still images are rendered from 8-bit or half float buffers only, deeper formats map to float16
+        if (pixelFormat == float16 || pixelFormat == r16 || pixelFormat == float32) {
             format = {4, JXL_TYPE_FLOAT16, JXL_NATIVE_ENDIAN, 0};
         } else if (pixelFormat == r8) {
             format = {4, JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
@@ -106,7 +107,7 @@ bool DecodeJpegXlOneShot(const uint8_t *jxl, size_t size,
                 *useFloats = true;
                 hdrImage = true;
                 format = { static_cast<uint32_t>(baseComponents), JXL_TYPE_FLOAT16, JXL_NATIVE_ENDIAN, 0 };
-            } else if (pixelFormat == float16) {
+            } else if (pixelFormat == float16 || pixelFormat == r16 || pixelFormat == float32) {
                 *useFloats = true;
                 hdrImage = true;
                 format = { static_cast<uint32_t>(baseComponents), JXL_TYPE_FLOAT16, JXL_NATIVE_ENDIAN, 0 };
@@ -226,6 +227,9 @@ bool DecodeBasicInfo(const uint8_t *jxl, size_t size, size_t *xsize, size_t *ysi
  * @param xsize width of the input image
  * @param ysize height of the input image
  * @param compressed will be populated with the compressed bytes
+ * @param numThreads worker threads for libjxl, 0 means one per core, 1 encodes on the calling thread
+ * @param options optional frame settings applied on top of effort and decoding speed
+ * @param metadata optional ICC profile and Exif, XMP, JUMBF boxes
  */
 bool EncodeJxlOneshot(const std::vector<uint8_t> &pixels, const uint32_t xsize,
                       const uint32_t ysize, std::vector<uint8_t> *compressed,
@@ -233,14 +237,21 @@ bool EncodeJxlOneshot(const std::vector<uint8_t> &pixels, const uint32_t xsize,
                       JxlCompressionOption compressionOption,
                       float compressionDistance,
                       int effort,
-                      int decodingSpeed) {
+                      int decodingSpeed,
+                      int numThreads,
+                      const jxlcoder::JxlEncoderOptions &options,
+                      const jxlcoder::JxlEncoderMetadata &metadata) {
     auto enc = JxlEncoderMake(nullptr);
-    auto runner = JxlThreadParallelRunnerMake(nullptr,
-                                              JxlThreadParallelRunnerDefaultNumWorkerThreads());
-    if (JXL_ENC_SUCCESS != JxlEncoderSetParallelRunner(enc.get(),
-                                                       JxlThreadParallelRunner,
-                                                       runner.get())) {
-        return false;
+    JxlThreadParallelRunnerPtr runner;
+    if (numThreads != 1) {
+        runner = JxlThreadParallelRunnerMake(nullptr,
+                                             numThreads > 0 ? static_cast<size_t>(numThreads)
+                                             : JxlThreadParallelRunnerDefaultNumWorkerThreads());
+        if (JXL_ENC_SUCCESS != JxlEncoderSetParallelRunner(enc.get(),
+                                                           JxlThreadParallelRunner,
+                                                           runner.get())) {
+            return false;
+        }
     }
 
     JxlPixelFormat pixel_format = {3, JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
@@ -251,6 +262,22 @@ bool EncodeJxlOneshot(const std::vector<uint8_t> &pixels, const uint32_t xsize,
         case rgba:
             pixel_format = {4, JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
             break;
+        case gray:
+            pixel_format = {1, JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
+            break;
+        case grayAlpha:
+            pixel_format = {2, JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0};
+            break;
+    }
+
+    const bool hasAlpha = colorspace == rgba || colorspace == grayAlpha;
+
+    if (!jxlcoder::ApplyCodestreamLevel(enc.get(), options)) {
+        return false;
+    }
+
+    if (!jxlcoder::PrepareMetadataBoxes(enc.get(), metadata)) {
+        return false;
     }
 
     JxlBasicInfo basicInfo;
@@ -259,9 +286,9 @@ bool EncodeJxlOneshot(const std::vector<uint8_t> &pixels, const uint32_t xsize,
     basicInfo.ysize = ysize;
     basicInfo.bits_per_sample = 8;
     basicInfo.uses_original_profile = compressionOption == loosy ? JXL_FALSE : JXL_TRUE;
-    basicInfo.num_color_channels = 3;
+    basicInfo.num_color_channels = pixel_format.num_channels < 3 ? 1 : 3;
 
-    if (colorspace == rgba) {
+    if (hasAlpha) {
         basicInfo.num_extra_channels = 1;
         basicInfo.alpha_bits = 8;
     }
@@ -274,8 +301,11 @@ bool EncodeJxlOneshot(const std::vector<uint8_t> &pixels, const uint32_t xsize,
         case rgb:
             basicInfo.num_color_channels = 3;
             break;
+        case gray:
+            basicInfo.num_color_channels = 1;
+            break;
         case rgba:
-            basicInfo.num_color_channels = 4;
+        case grayAlpha:
             JxlExtraChannelInfo channelInfo;
             JxlEncoderInitExtraChannelInfo(JXL_CHANNEL_ALPHA, &channelInfo);
             channelInfo.bits_per_sample = 8;
@@ -286,10 +316,7 @@ bool EncodeJxlOneshot(const std::vector<uint8_t> &pixels, const uint32_t xsize,
             break;
     }
 
-    JxlColorEncoding color_encoding = {};
-    JxlColorEncodingSetToSRGB(&color_encoding, pixel_format.num_channels < 3);
-    if (JXL_ENC_SUCCESS !=
-        JxlEncoderSetColorEncoding(enc.get(), &color_encoding)) {
+    if (!jxlcoder::ApplyColorProfile(enc.get(), metadata, pixel_format.num_channels < 3)) {
         return false;
     }
 
@@ -318,7 +345,7 @@ bool EncodeJxlOneshot(const std::vector<uint8_t> &pixels, const uint32_t xsize,
         return false;
     }
 
-    if (colorspace == rgba) {
+    if (hasAlpha) {
         if (JXL_ENC_SUCCESS !=
             JxlEncoderSetExtraChannelDistance(frameSettings, 0, compressionDistance)) {
             return false;
@@ -331,6 +358,10 @@ bool EncodeJxlOneshot(const std::vector<uint8_t> &pixels, const uint32_t xsize,
         return false;
     }
 
+    if (!jxlcoder::ApplyFrameOptions(frameSettings, options)) {
+        return false;
+    }
+
     if (JXL_ENC_SUCCESS !=
         JxlEncoderAddImageFrame(frameSettings, &pixel_format,
                                 (void *) pixels.data(),
@@ -338,6 +369,10 @@ bool EncodeJxlOneshot(const std::vector<uint8_t> &pixels, const uint32_t xsize,
         return false;
     }
 
+    if (!jxlcoder::AddMetadataBoxes(enc.get(), metadata)) {
+        return false;
+    }
+
     JxlEncoderCloseInput(enc.get());
 
     compressed->resize(64);
@@ -33,6 +33,8 @@
 #ifdef __cplusplus
 
 #include "JxlDefinitions.h"
+#include "JxlEncoderOptions.hpp"
+#include "JxlEncoderMetadata.hpp"
 
 bool DecodeJpegXlOneShot(const uint8_t *jxl, size_t size,
                          std::vector<uint8_t> *pixels, size_t *xsize,
@@ -50,7 +52,10 @@ bool EncodeJxlOneshot(const std::vector<uint8_t> &pixels, const uint32_t xsize,
                       JxlCompressionOption compressionOption,
                       float compressionDistance,
                       int effort,
-                      int decodingSpeed);
+                      int decodingSpeed,
+                      int numThreads = 0,
+                      const jxlcoder::JxlEncoderOptions &options = jxlcoder::JxlEncoderOptions(),
+                      const jxlcoder::JxlEncoderMetadata &metadata = jxlcoder::JxlEncoderMetadata());
 
 bool isJXL(std::vector<uint8_t>& src);
 
@@ -0,0 +1,247 @@
+//
+//  JxlYuvConverter.cpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#include "JxlYuvConverter.hpp"
+#include "concurrency.hpp"
+#include <algorithm>
+#include <cmath>
+
+#include <hwy/foreach_target.h>  // IWYU pragma: keep
+#include <hwy/highway.h>
+#include "hwy/base.h"
+
+namespace jxlcoder {
+
+using namespace hwy;
+using namespace hwy::HWY_NAMESPACE;
+
+/**
+ * Offsets and multipliers that map source code values straight to the output range
+ */
+struct JxlYuvCoefficients {
+    float yOffset;
+    float cOffset;
+    float yScale;
+    float crToR;
+    float cbToG;
+    float crToG;
+    float cbToB;
+    float cScale;
+    float maxValue;
+};
+
+static JxlYuvCoefficients JxlMakeYuvCoefficients(JxlYuvMatrix matrix, JxlYuvRange range,
+                                                 bool tenBits, bool output16) {
+    float kr = 0.2126f, kb = 0.0722f;
+    switch (matrix) {
+        case JXL_YUV_BT601:
+            kr = 0.299f;
+            kb = 0.114f;
+            break;
+        case JXL_YUV_BT709:
+            kr = 0.2126f;
+            kb = 0.0722f;
+            break;
+        case JXL_YUV_BT2020:
+            kr = 0.2627f;
+            kb = 0.0593f;
+            break;
+    }
+    const float kg = 1.f - kr - kb;
+    const float depthScale = tenBits ? 4.f : 1.f;
+    const float maxValue = output16 ? 65535.f : 255.f;
+
+    JxlYuvCoefficients coefficients;
+    coefficients.maxValue = maxValue;
+    coefficients.cOffset = 128.f * depthScale;
+    if (range == JXL_YUV_RANGE_LIMITED) {
+        coefficients.yOffset = 16.f * depthScale;
+        coefficients.yScale = maxValue / (219.f * depthScale);
+        coefficients.cScale = maxValue / (224.f * depthScale);
+    } else {
+        coefficients.yOffset = 0.f;
+        coefficients.yScale = maxValue / (tenBits ? 1023.f : 255.f);
+        coefficients.cScale = maxValue / (tenBits ? 1023.f : 255.f);
+    }
+    coefficients.crToR = 2.f * (1.f - kr) * coefficients.cScale;
+    coefficients.cbToB = 2.f * (1.f - kb) * coefficients.cScale;
+    coefficients.cbToG = -2.f * kb * (1.f - kb) / kg * coefficients.cScale;
+    coefficients.crToG = -2.f * kr * (1.f - kr) / kg * coefficients.cScale;
+    return coefficients;
+}
+
+template<typename T>
+static inline void JxlStoreRgbPixel(T *dst, const uint32_t channels, const JxlYuvCoefficients &c,
+                                    const float y, const float cb, const float cr) {
+    const float luma = (y - c.yOffset) * c.yScale;
+    const float u = cb - c.cOffset;
+    const float v = cr - c.cOffset;
+    dst[0] = static_cast<T>(std::clamp(std::round(luma + c.crToR * v), 0.f, c.maxValue));
+    dst[1] = static_cast<T>(std::clamp(std::round(luma + c.cbToG * u + c.crToG * v), 0.f, c.maxValue));
+    dst[2] = static_cast<T>(std::clamp(std::round(luma + c.cbToB * u), 0.f, c.maxValue));
+    if (channels == 4) {
+        dst[3] = static_cast<T>(c.maxValue);
+    }
+}
+
+/**
+ * Converts one output row, chroma arrives as four luma-sized vectors per eight pixels
+ */
+template<typename T>
+static void JxlConvertYuvRow(const JxlYuvFrame &frame, const uint32_t row, const uint32_t width,
+                             T *__restrict__ dst, const uint32_t channels, const JxlYuvCoefficients &c) {
+    const FixedTag<float, 4> df;
+    const Rebind<int32_t, decltype(df)> di;
+    const Rebind<uint8_t, decltype(df)> du8;
+    const Rebind<uint16_t, decltype(df)> du16;
+    const Rebind<T, decltype(df)> dOut;
+    using VF = Vec<decltype(df)>;
+
+    const uint8_t *yRow = frame.y + row * frame.yStride;
+    const uint8_t *uRow = frame.u + (row / 2) * frame.uStride;
+    const uint8_t *vRow = frame.layout == JXL_YUV_I420 ? frame.v + (row / 2) * frame.vStride : nullptr;
+    const bool tenBits = frame.layout == JXL_YUV_P010;
+
+    const VF yOffset = Set(df, c.yOffset);
+    const VF cOffset = Set(df, c.cOffset);
+    const VF yScale = Set(df, c.yScale);
+    const VF crToR = Set(df, c.crToR);
+    const VF cbToG = Set(df, c.cbToG);
+    const VF crToG = Set(df, c.crToG);
+    const VF cbToB = Set(df, c.cbToB);
+    const auto alpha = Set(dOut, static_cast<T>(c.maxValue));
+
+    auto loadU8 = [&](const uint8_t *src) -> VF {
+        return ConvertTo(df, PromoteTo(di, LoadU(du8, src)));
+    };
+    auto loadP010 = [&](const uint8_t *src) -> VF {
+        const auto samples = ShiftRight<6>(LoadU(du16, reinterpret_cast<const uint16_t *>(src)));
+        return ConvertTo(df, BitCast(di, PromoteTo(Rebind<uint32_t, decltype(df)>(), samples)));
+    };
+
+    auto convert = [&](VF y, VF cb, VF cr, T *out) {
+        const VF luma = Mul(Sub(y, yOffset), yScale);
+        cb = Sub(cb, cOffset);
+        cr = Sub(cr, cOffset);
+        const VF r = MulAdd(crToR, cr, luma);
+        const VF g = MulAdd(crToG, cr, MulAdd(cbToG, cb, luma));
+        const VF b = MulAdd(cbToB, cb, luma);
+        const auto r8 = DemoteTo(dOut, NearestInt(r));
+        const auto g8 = DemoteTo(dOut, NearestInt(g));
+        const auto b8 = DemoteTo(dOut, NearestInt(b));
+        if (channels == 4) {
+            StoreInterleaved4(r8, g8, b8, alpha, dOut, out);
+        } else {
+            StoreInterleaved3(r8, g8, b8, dOut, out);
+        }
+    };
+
+    uint32_t x = 0;
+    for (; x + 8 <= width; x += 8) {
+        VF y0, y1, cbLow, cbHigh, crLow, crHigh;
+        if (frame.layout == JXL_YUV_I420) {
+            y0 = loadU8(yRow + x);
+            y1 = loadU8(yRow + x + 4);
+            const VF cb = loadU8(uRow + x / 2);
+            const VF cr = loadU8(vRow + x / 2);
+            cbLow = InterleaveLower(df, cb, cb);
+            cbHigh = InterleaveUpper(df, cb, cb);
+            crLow = InterleaveLower(df, cr, cr);
+            crHigh = InterleaveUpper(df, cr, cr);
+        } else {
+            VF uv0, uv1;
+            if (tenBits) {
+                y0 = loadP010(yRow + x * 2);
+                y1 = loadP010(yRow + x * 2 + 8);
+                uv0 = loadP010(uRow + x * 2);
+                uv1 = loadP010(uRow + x * 2 + 8);
+            } else {
+                y0 = loadU8(yRow + x);
+                y1 = loadU8(yRow + x + 4);
+                uv0 = loadU8(uRow + x);
+                uv1 = loadU8(uRow + x + 4);
+            }
+            // uv0 holds Cb0 Cr0 Cb1 Cr1, replicating each sample covers the two luma pixels it belongs to
+            const VF cb0 = ConcatEven(df, uv0, uv0);
+            const VF cr0 = ConcatOdd(df, uv0, uv0);
+            const VF cb1 = ConcatEven(df, uv1, uv1);
+            const VF cr1 = ConcatOdd(df, uv1, uv1);
+            cbLow = InterleaveLower(df, cb0, cb0);
+            crLow = InterleaveLower(df, cr0, cr0);
+            cbHigh = InterleaveLower(df, cb1, cb1);
+            crHigh = InterleaveLower(df, cr1, cr1);
+        }
+        convert(y0, cbLow, crLow, dst + x * channels);
+        convert(y1, cbHigh, crHigh, dst + (x + 4) * channels);
+    }
+
+    for (; x < width; ++x) {
+        const uint32_t cx = x / 2;
+        float y, cb, cr;
+        if (frame.layout == JXL_YUV_I420) {
+            y = yRow[x];
+            cb = uRow[cx];
+            cr = vRow[cx];
+        } else if (tenBits) {
+            const auto yRow16 = reinterpret_cast<const uint16_t *>(yRow);
+            const auto uvRow16 = reinterpret_cast<const uint16_t *>(uRow);
+            y = static_cast<float>(yRow16[x] >> 6);
+            cb = static_cast<float>(uvRow16[cx * 2] >> 6);
+            cr = static_cast<float>(uvRow16[cx * 2 + 1] >> 6);
+        } else {
+            y = yRow[x];
+            cb = uRow[cx * 2];
+            cr = uRow[cx * 2 + 1];
+        }
+        JxlStoreRgbPixel(dst + x * channels, channels, c, y, cb, cr);
+    }
+}
+
+bool JxlConvertYuvToRgb(const JxlYuvFrame &frame, uint32_t width, uint32_t height,
+                        uint8_t *dst, uint32_t channels, bool output16, int numThreads) {
+    if (!frame.y || !frame.u || (frame.layout == JXL_YUV_I420 && !frame.v)) {
+        return false;
+    }
+    if (channels != 3 && channels != 4) {
+        return false;
+    }
+    const JxlYuvCoefficients coefficients = JxlMakeYuvCoefficients(frame.matrix, frame.range,
+                                                                   frame.layout == JXL_YUV_P010, output16);
+    const size_t dstStride = static_cast<size_t>(width) * channels * (output16 ? sizeof(uint16_t) : sizeof(uint8_t));
+    const int threads = std::clamp(numThreads, 1, static_cast<int>(std::max(height, 1u)));
+
+    concurrency::parallel_for(threads, static_cast<int>(height), [&](int y) {
+        uint8_t *dstRow = dst + y * dstStride;
+        if (output16) {
+            JxlConvertYuvRow(frame, static_cast<uint32_t>(y), width,
+                             reinterpret_cast<uint16_t *>(dstRow), channels, coefficients);
+        } else {
+            JxlConvertYuvRow(frame, static_cast<uint32_t>(y), width, dstRow, channels, coefficients);
+        }
+    });
+    return true;
+}
+
+}
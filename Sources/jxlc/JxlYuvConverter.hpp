@@ -0,0 +1,84 @@
+//
+//  JxlYuvConverter.hpp
+//  JxclCoder [https://github.com/awxkee/jxl-coder-swift]
+//
+//  Created by Radzivon Bartoshyk on 19/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+#pragma once
+
+#ifdef __cplusplus
+
+#include <cstdint>
+#include <cstddef>
+
+namespace jxlcoder {
+
+enum JxlYuvLayout {
+    /// Three 8-bit planes, chroma subsampled 2x2
+    JXL_YUV_I420 = 1,
+    /// 8-bit luma plane followed by interleaved CbCr at half resolution
+    JXL_YUV_NV12 = 2,
+    /// NV12 with 16-bit little endian samples holding 10 bits in the high bits
+    JXL_YUV_P010 = 3
+};
+
+enum JxlYuvMatrix {
+    JXL_YUV_BT601 = 1,
+    JXL_YUV_BT709 = 2,
+    JXL_YUV_BT2020 = 3
+};
+
+enum JxlYuvRange {
+    JXL_YUV_RANGE_LIMITED = 1,
+    JXL_YUV_RANGE_FULL = 2
+};
+
+/**
+ * Borrowed planes of a 4:2:0 frame, strides are in bytes.
+ * For NV12 and P010 `u` holds the interleaved CbCr plane and `v` is unused.
+ */
+struct JxlYuvFrame {
+    JxlYuvLayout layout = JXL_YUV_NV12;
+    JxlYuvMatrix matrix = JXL_YUV_BT709;
+    JxlYuvRange range = JXL_YUV_RANGE_LIMITED;
+    const uint8_t *y = nullptr;
+    size_t yStride = 0;
+    const uint8_t *u = nullptr;
+    size_t uStride = 0;
+    const uint8_t *v = nullptr;
+    size_t vStride = 0;
+};
+
+/**
+ * Converts a 4:2:0 frame into tightly packed RGB or RGBA with opaque alpha, chroma is upsampled by replication.
+ *
+ * @param channels 3 or 4
+ * @param output16 writes 16-bit native endian samples instead of 8-bit ones
+ * @param numThreads rows are split into this many stripes
+ * @return false when the frame description is incomplete
+ */
+bool JxlConvertYuvToRgb(const JxlYuvFrame &frame, uint32_t width, uint32_t height,
+                        uint8_t *dst, uint32_t channels, bool output16, int numThreads);
+
+}
+
+#endif